@@ -18,11 +18,13 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #ifndef _25LC512_H
 #define _25LC512_H
 
+#include <stdint.h>
+
 #define _25LC512_MAX_SPI_CLOCK 20000000UL // 20 MHz
 
 /**
 @brief Driver for SPI EEPROM 25AA512/25LC512
-@param SPIMaster Driver class for SPI master implementing a static put() method
+@param SPIMaster Driver class for SPI master implementing static put() and get() methods
 @param SSPin Driver class for SS (output) pin
 */
 template <typename SPIMaster, typename SSPin>
@@ -47,98 +49,226 @@ class _25LC512
     */
     static void init()
     {
-        // Enable device (active low)
-        SSPin::low();
-        
         // Send write enable
-        SPIMaster::put(INSTRUCTION_WREN);
-        
-        // Disable device (active low)
-        SSPin::high();
+        writeEnable();
+    }
+
+    /**
+    @brief Get 25LC512 EEPROM page size in bytes
+    @result EEPROM page size in bytes
+    @note A single WRITE instruction can only program bytes within one page. Exceeding the page boundary will wrap around to the beginning of the page
+    */
+    static constexpr uint8_t pageSize()
+    {
+        return 128;
+    }
+
+    /**
+    @brief Get the number of bytes which can be programmed by a single WRITE instruction
+    @param address Address of first byte
+    @param nofBytes Number of bytes to be written
+    @result Number of bytes until the end of the page containing address, limited to nofBytes
+    */
+    template <typename Length>
+    static constexpr uint8_t getChunkSize(const Address address, const Length nofBytes)
+    {
+        const uint8_t chunkSize = pageSize() - (address & (pageSize() - 1));
+        return (nofBytes < chunkSize) ? nofBytes : chunkSize;
+    }
+
+    /**
+    @brief Get 25LC512 EEPROM sector size in bytes
+    @result EEPROM sector size in bytes
+    */
+    static constexpr uint16_t sectorSize()
+    {
+        return 16384;
+    }
+
+    /**
+    @brief Get the maximum SPI clock of the device
+    @result Maximum SPI clock in Hz
+    */
+    static constexpr uint32_t getMaxSPIClock()
+    {
+        return _25LC512_MAX_SPI_CLOCK;
+    }
+
+    /**
+    @brief Check if an internal write cycle is in progress
+    @result true if the write-in-process (WIP) bit of the status register is set
+    */
+    static bool isBusy()
+    {
+        return readStatus() & _BV(STATUS_WIP);
+    }
+
+    /**
+    @brief Wait until the current internal write cycle is finished
+    @note This method polls the WIP bit instead of waiting for the worst-case write cycle time of 5 ms. All other methods call this before accessing the memory array, so explicit calls are only needed e.g. before power-down
+    */
+    static void waitWhileBusy()
+    {
+        while (isBusy());
     }
 
     /**
     @brief Write one byte to EEPROM at given position
     @param address Position in EEPROM (0..65535)
     @param data Byte to be written to EEPROM
+    @note This method returns as soon as the byte has been transferred to the device, i.e. without waiting for the internal write cycle to finish
     */
     static void write(const Address address, const uint8_t data)
     {
-        // Enable device (active low)
-        SSPin::low();
-        
-        // Set Instruction
-        SPIMaster::put(INSTRUCTION_WRITE);
-        
-        // Set Address MSB
-        SPIMaster::put(address);
-        
-        // Set Address LSB
-        SPIMaster::put(address >> 8);
-        
-        // Store data
-        SPIMaster::put(data);
-        
-        // Disable device (active low)
-        SSPin::high();
+        write(address, &data, 1);
     }
 
     /**
     @brief Write multiple Bytes to EEPROM starting at given position
     @param address Position of first byte in EEPROM (0..65535)
     @param data Bytes to be written to EEPROM
-    @param nofBytes Number of Bytes to be written to EEPROM (1..65535)
+    @param nofBytes Number of Bytes to be written to EEPROM (1..65536)
+    @note Data will be split into page-aligned chunks, each one programmed by a separate WRITE instruction. The status register is polled before each chunk, so there is no need for additional delays. This method returns without waiting for the internal write cycle of the last chunk to finish
     */
     template <typename Length>
-    static void write(const Address address, const uint8_t * data, const Length nofBytes)
+    static void write(Address address, const uint8_t * data, Length nofBytes)
     {
-        // Enable device (active low)
-        SSPin::low();
+        while (nofBytes > 0)
+        {
+            const uint8_t chunkSize = getChunkSize(address, nofBytes);
+            
+            writePage(address, data, chunkSize);
+            
+            address += chunkSize;
+            data += chunkSize;
+            nofBytes -= chunkSize;
+        }
+    }
+
+    /**
+    @brief Fill EEPROM with one byte value starting at given position
+    @param address Position of first byte in EEPROM (0..65535)
+    @param data Byte value to be written to EEPROM
+    @param nofBytes Number of Bytes to be filled on EEPROM (1..65536)
+    @note Filling with 0xFF (i.e. the erased state) uses chip, sector and page erase for all aligned regions. Other values and unaligned regions are programmed page by page
+    */
+    template <typename Length>
+    static void fill(Address address, const uint8_t data, Length nofBytes)
+    {
+        // Erasing the whole memory array is done by a single instruction
+        if (data == 0xFF && address == 0 && nofBytes >= capacity())
+        {
+            eraseChip();
+            return;
+        }
         
-        // Set Instruction
-        SPIMaster::put(INSTRUCTION_WRITE);
+        while (nofBytes > 0)
+        {
+            if (data == 0xFF)
+            {
+                if (isAligned(address, sectorSize()) && nofBytes >= sectorSize())
+                {
+                    eraseSector(address);
+                    address += sectorSize();
+                    nofBytes -= sectorSize();
+                    continue;
+                }
+                
+                if (isAligned(address, pageSize()) && nofBytes >= pageSize())
+                {
+                    erasePage(address);
+                    address += pageSize();
+                    nofBytes -= pageSize();
+                    continue;
+                }
+            }
+            
+            const uint8_t chunkSize = getChunkSize(address, nofBytes);
+            
+            fillPage(address, data, chunkSize);
+            
+            address += chunkSize;
+            nofBytes -= chunkSize;
+        }
+    }
+
+    /**
+    @brief Erase EEPROM (i.e. set to 0xFF) starting at given position
+    @param address Position of first byte in EEPROM (0..65535)
+    @param nofBytes Number of Bytes to be erased (1..65536)
+    */
+    template <typename Length>
+    static void erase(const Address address, const Length nofBytes)
+    {
+        fill(address, 0xFF, nofBytes);
+    }
+
+    /**
+    @brief Erase the page containing given position
+    @param address Any position within the page to be erased (0..65535)
+    */
+    static void erasePage(const Address address)
+    {
+        eraseInstruction(INSTRUCTION_PE, address);
+    }
+
+    /**
+    @brief Erase the sector containing given position
+    @param address Any position within the sector to be erased (0..65535)
+    */
+    static void eraseSector(const Address address)
+    {
+        eraseInstruction(INSTRUCTION_SE, address);
+    }
+
+    /**
+    @brief Erase the whole memory array
+    */
+    static void eraseChip()
+    {
+        // Wait for previous write cycle to finish
+        waitWhileBusy();
         
-        // Set Address MSB
-        SPIMaster::put(address);
+        // Write enable latch is reset after every write cycle
+        writeEnable();
         
-        // Set Address LSB
-        SPIMaster::put(address >> 8);
+        // Enable device (active low)
+        SSPin::low();
         
-        // Store data
-        SPIMaster::put(data, nofBytes);
+        // Set Instruction
+        SPIMaster::put(INSTRUCTION_CE);
         
-        // Disable device (active low)
+        // Disable device (active low). This starts the internal erase cycle
         SSPin::high();
     }
 
     /**
-    @brief Write one Byte to EEPROM starting at given position
-    @param pos Position of first byte in EEPROM (0..65535)
+    @brief Start programming a chunk of data within one page
+    This is the low-level primitive for non-blocking write schemes, which check isBusy() on their own before starting the next chunk
+    @param address Position of first byte in EEPROM (0..65535)
     @param data Bytes to be written to EEPROM
-    @param nofBytes Number of Bytes to be filled on EEPROM (1..65535)
+    @param nofBytes Number of Bytes to be written to EEPROM (1..pageSize())
+    @note The chunk must not cross a page boundary. The device must not be busy, i.e. isBusy() must have returned false
     */
     template <typename Length>
-    static void fill(const Address address, const uint8_t data, const Length nofBytes)
+    static void programPage(const Address address, const uint8_t * data, const Length nofBytes)
     {
+        // Write enable latch is reset after every write cycle
+        writeEnable();
+        
         // Enable device (active low)
         SSPin::low();
-
+        
         // Set Instruction
         SPIMaster::put(INSTRUCTION_WRITE);
         
-        // Set Address MSB
-        SPIMaster::put(address);
-        
-        // Set Address LSB
-        SPIMaster::put(address >> 8);
+        // Set Address
+        putAddress(address);
         
         // Store data
-        for (; nofBytes > 0; --nofBytes)
-        {
-            SPIMaster::put(data);
-        }
+        SPIMaster::put(data, nofBytes);
         
-        // Disable device (active low)
+        // Disable device (active low). This starts the internal write cycle
         SSPin::high();
     }
 
@@ -149,17 +279,17 @@ class _25LC512
     */
     static uint8_t read(const Address address)
     {
+        // Memory array cannot be read during a write cycle
+        waitWhileBusy();
+        
         // Enable device (active low)
         SSPin::low();
         
         // Set Instruction
         SPIMaster::put(INSTRUCTION_READ);
         
-        // Set Address MSB
-        SPIMaster::put(address);
-        
-        // Set Address LSB
-        SPIMaster::put(address >> 8);
+        // Set Address
+        putAddress(address);
         
         // Load data
         const uint8_t data = SPIMaster::get();
@@ -179,17 +309,17 @@ class _25LC512
     template <typename Length>
     static void read(const Address address, uint8_t * data, const Length nofBytes)
     {
+        // Memory array cannot be read during a write cycle
+        waitWhileBusy();
+        
         // Enable device (active low)
         SSPin::low();
         
         // Set Instruction
         SPIMaster::put(INSTRUCTION_READ);
         
-        // Set Address MSB
-        SPIMaster::put(address);
-        
-        // Set Address LSB
-        SPIMaster::put(address >> 8);
+        // Set Address
+        putAddress(address);
         
         // Load data
         SPIMaster::get(data, nofBytes);
@@ -200,6 +330,124 @@ class _25LC512
     
     private:
     
+    // Read status register
+    static uint8_t readStatus()
+    {
+        // Enable device (active low)
+        SSPin::low();
+        
+        // Set Instruction
+        SPIMaster::put(INSTRUCTION_RDSR);
+        
+        // Load status register
+        const uint8_t status = SPIMaster::get();
+        
+        // Disable device (active low)
+        SSPin::high();
+        
+        return status;
+    }
+    
+    // Set write enable latch. This is needed before every write instruction, as the latch is reset after each write cycle
+    static void writeEnable()
+    {
+        // Enable device (active low)
+        SSPin::low();
+        
+        // Send write enable
+        SPIMaster::put(INSTRUCTION_WREN);
+        
+        // Disable device (active low)
+        SSPin::high();
+    }
+    
+    // Transfer 16 bit address, MSB first
+    static void putAddress(const Address address) __attribute__((always_inline))
+    {
+        // Set Address MSB
+        SPIMaster::put(address >> 8);
+        
+        // Set Address LSB
+        SPIMaster::put(address);
+    }
+    
+    // Write a chunk of data not crossing a page boundary
+    template <typename Length>
+    static void writePage(const Address address, const uint8_t * data, const Length nofBytes)
+    {
+        // Wait for previous write cycle to finish
+        waitWhileBusy();
+        
+        programPage(address, data, nofBytes);
+    }
+    
+    // Fill a chunk not crossing a page boundary with one byte value
+    template <typename Length>
+    static void fillPage(const Address address, const uint8_t data, Length nofBytes)
+    {
+        // Wait for previous write cycle to finish
+        waitWhileBusy();
+        
+        // Write enable latch is reset after every write cycle
+        writeEnable();
+        
+        // Enable device (active low)
+        SSPin::low();
+        
+        // Set Instruction
+        SPIMaster::put(INSTRUCTION_WRITE);
+        
+        // Set Address
+        putAddress(address);
+        
+        // Store data
+        for (; nofBytes > 0; --nofBytes)
+        {
+            SPIMaster::put(data);
+        }
+        
+        // Disable device (active low). This starts the internal write cycle
+        SSPin::high();
+    }
+    
+    // Send page or sector erase instruction
+    static void eraseInstruction(const uint8_t instruction, const Address address)
+    {
+        // Wait for previous write cycle to finish
+        waitWhileBusy();
+        
+        // Write enable latch is reset after every write cycle
+        writeEnable();
+        
+        // Enable device (active low)
+        SSPin::low();
+        
+        // Set Instruction
+        SPIMaster::put(instruction);
+        
+        // Set Address
+        putAddress(address);
+        
+        // Disable device (active low). This starts the internal erase cycle
+        SSPin::high();
+    }
+    
+    // Check if address is aligned to given block size (power of two)
+    static constexpr bool isAligned(const Address address, const uint16_t blockSize)
+    {
+        return (address & (blockSize - 1)) == 0;
+    }
+    
+    // Status register bits
+    enum
+    {
+        STATUS_WIP = 0,
+        STATUS_WEL = 1,
+        STATUS_BP0 = 2,
+        STATUS_BP1 = 3,
+        STATUS_WPEN = 7
+    };
+    
     enum
     {
         INSTRUCTION_READ = 0b11,
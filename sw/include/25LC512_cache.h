@@ -0,0 +1,260 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _25LC512_CACHE_H
+#define _25LC512_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+@brief Write-back cache for SPI EEPROM 25AA512/25LC512
+The cache holds t_nofLines EEPROM pages in RAM. Reads and writes hitting a cached page are served without SPI traffic.
+Modified bytes are tracked per line and written back with a single page write on flush() or when the line is evicted (least recently used first).
+Writing a value equal to the cached one does not mark the line as modified.
+@tparam EEPROM EEPROM driver class, i.e. a specialization of _25LC512
+@tparam t_nofLines Number of cache lines (1..255). Each line occupies EEPROM::pageSize() bytes of RAM plus 6 bytes overhead
+@note Data written to the cache is not persistent until flush() has been called
+*/
+template <typename EEPROM, uint8_t t_nofLines = 1>
+class _25LC512_Cache
+{
+    static_assert(t_nofLines > 0, "At least one cache line is needed");
+
+    public:
+
+    /// @brief Data type for memory address/offset
+    typedef typename EEPROM::Address Address;
+
+    /**
+    @brief Read one byte from given position
+    @param address Position in EEPROM (0..65535)
+    @result data Byte read from cache
+    */
+    static uint8_t read(const Address address)
+    {
+        return getLine(address).data[getOffset(address)];
+    }
+
+    /**
+    @brief Read multiple Bytes starting at given position
+    @param address Position of first byte in EEPROM (0..65535)
+    @param data Bytes to be read
+    @param nofBytes Number of Bytes to be read
+    */
+    template <typename Length>
+    static void read(Address address, uint8_t * data, Length nofBytes)
+    {
+        for (; nofBytes > 0; --nofBytes)
+        {
+            *data++ = read(address++);
+        }
+    }
+
+    /**
+    @brief Write one byte to given position
+    @param address Position in EEPROM (0..65535)
+    @param data Byte to be written to cache
+    */
+    static void write(const Address address, const uint8_t data)
+    {
+        Line & line = getLine(address);
+        const uint8_t offset = getOffset(address);
+
+        // Unchanged data does not need to be written back
+        if (line.data[offset] == data)
+        {
+            return;
+        }
+
+        line.data[offset] = data;
+
+        // Extend modified range of this line
+        if (line.dirtyBegin >= line.dirtyEnd)
+        {
+            line.dirtyBegin = offset;
+            line.dirtyEnd = offset + 1;
+        }
+        else if (offset < line.dirtyBegin)
+        {
+            line.dirtyBegin = offset;
+        }
+        else if (offset >= line.dirtyEnd)
+        {
+            line.dirtyEnd = offset + 1;
+        }
+    }
+
+    /**
+    @brief Write multiple Bytes starting at given position
+    @param address Position of first byte in EEPROM (0..65535)
+    @param data Bytes to be written
+    @param nofBytes Number of Bytes to be written
+    */
+    template <typename Length>
+    static void write(Address address, const uint8_t * data, Length nofBytes)
+    {
+        for (; nofBytes > 0; --nofBytes)
+        {
+            write(address++, *data++);
+        }
+    }
+
+    /**
+    @brief Write all modified cache lines back to EEPROM
+    @note Each modified line is written by one page write covering the modified range only
+    */
+    static void flush()
+    {
+        for (uint8_t lineIdx = 0; lineIdx < t_nofLines; ++lineIdx)
+        {
+            writeBack(s_lines[lineIdx]);
+        }
+    }
+
+    /**
+    @brief Discard all cache lines without writing them back
+    @note Subsequent accesses will re-load the data from EEPROM, e.g. after the EEPROM has been written directly
+    */
+    static void invalidate()
+    {
+        for (uint8_t lineIdx = 0; lineIdx < t_nofLines; ++lineIdx)
+        {
+            s_lines[lineIdx].valid = false;
+            s_lines[lineIdx].dirtyBegin = 0;
+            s_lines[lineIdx].dirtyEnd = 0;
+        }
+    }
+
+    /**
+    @brief Check if there are modified cache lines
+    @result true if flush() would write data to EEPROM
+    */
+    static bool isDirty()
+    {
+        for (uint8_t lineIdx = 0; lineIdx < t_nofLines; ++lineIdx)
+        {
+            if (s_lines[lineIdx].dirtyBegin < s_lines[lineIdx].dirtyEnd)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    private:
+
+    // Cached EEPROM page
+    struct Line
+    {
+        Address pageAddress;
+        bool valid;
+        uint8_t dirtyBegin; // Offset of first modified byte
+        uint8_t dirtyEnd; // Offset behind last modified byte
+        uint8_t data[EEPROM::pageSize()];
+    };
+
+    static constexpr Address getPageAddress(const Address address)
+    {
+        return address & ~static_cast<Address>(EEPROM::pageSize() - 1);
+    }
+
+    static constexpr uint8_t getOffset(const Address address)
+    {
+        return address & (EEPROM::pageSize() - 1);
+    }
+
+    // Write modified range of a line back to EEPROM
+    static void writeBack(Line & line)
+    {
+        if (line.dirtyBegin < line.dirtyEnd)
+        {
+            EEPROM::write(line.pageAddress + line.dirtyBegin, &line.data[line.dirtyBegin], static_cast<uint8_t>(line.dirtyEnd - line.dirtyBegin));
+            line.dirtyBegin = 0;
+            line.dirtyEnd = 0;
+        }
+    }
+
+    // Find the cache line for given address. On a miss, the least recently used line is written back and re-loaded
+    static Line & getLine(const Address address)
+    {
+        const Address pageAddress = getPageAddress(address);
+
+        // s_order holds the line indices from most recently used to least recently used
+        uint8_t rank = 0;
+        for (; rank < t_nofLines - 1; ++rank)
+        {
+            const Line & line = s_lines[s_order[rank]];
+            if (line.valid && line.pageAddress == pageAddress)
+            {
+                break;
+            }
+        }
+
+        // Move line to the front. If nothing has been found, this is the least recently used line
+        const uint8_t lineIdx = s_order[rank];
+        for (; rank > 0; --rank)
+        {
+            s_order[rank] = s_order[rank - 1];
+        }
+        s_order[0] = lineIdx;
+
+        Line & line = s_lines[lineIdx];
+        if (!line.valid || line.pageAddress != pageAddress)
+        {
+            writeBack(line);
+            EEPROM::read(pageAddress, line.data, EEPROM::pageSize());
+            line.pageAddress = pageAddress;
+            line.valid = true;
+        }
+
+        return line;
+    }
+
+    // Initial order of cache lines
+    struct Order
+    {
+        constexpr Order() : idx()
+        {
+            for (uint8_t rank = 0; rank < t_nofLines; ++rank)
+            {
+                idx[rank] = rank;
+            }
+        }
+
+        uint8_t & operator[](const uint8_t rank)
+        {
+            return idx[rank];
+        }
+
+        uint8_t idx[t_nofLines];
+    };
+
+    static Line s_lines[t_nofLines];
+    static Order s_order;
+};
+
+// Static initialization
+template <typename EEPROM, uint8_t t_nofLines>
+typename _25LC512_Cache<EEPROM, t_nofLines>::Line _25LC512_Cache<EEPROM, t_nofLines>::s_lines[t_nofLines];
+
+// Static initialization
+template <typename EEPROM, uint8_t t_nofLines>
+typename _25LC512_Cache<EEPROM, t_nofLines>::Order _25LC512_Cache<EEPROM, t_nofLines>::s_order;
+
+#endif
@@ -0,0 +1,314 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _25LC512_LOG_H
+#define _25LC512_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+@brief Wear-leveled circular record log on SPI EEPROM 25AA512/25LC512
+Each record occupies one EEPROM page and starts with a 6 byte header containing a sequence number (32 bit, little endian), the payload length and a checksum.
+Records are appended to consecutive pages, wrapping around at the end of the log area, so all pages are written equally often and there is no header page wearing out first.
+As sequence numbers increase along the pages up to the most recent record, the head of the log is found by a binary search over the page headers on boot.
+@tparam EEPROM EEPROM driver class, i.e. a specialization of _25LC512
+@tparam t_beginAddress Address of the first page of the log area (aligned to EEPROM::pageSize())
+@tparam t_nofPages Number of pages of the log area, i.e. the maximum number of records (2..EEPROM::capacity()/EEPROM::pageSize())
+@note The log area has to be erased once before first use, see format()
+*/
+template <typename EEPROM, typename EEPROM::Address t_beginAddress, uint16_t t_nofPages>
+class _25LC512_Log
+{
+    static_assert(t_beginAddress % EEPROM::pageSize() == 0, "Log area must be aligned to EEPROM pages");
+    static_assert(t_nofPages >= 2, "Log area must contain at least two pages");
+    static_assert(t_beginAddress + static_cast<uint32_t>(t_nofPages) * EEPROM::pageSize() <= EEPROM::capacity(), "Log area exceeds EEPROM capacity");
+
+    public:
+
+    /// @brief Data type for record sequence numbers
+    typedef uint32_t Sequence;
+
+    /**
+    @brief Get the maximum payload size of one record
+    @result Maximum payload size in bytes
+    */
+    static constexpr uint8_t maxRecordSize()
+    {
+        return EEPROM::pageSize() - HEADER_SIZE;
+    }
+
+    /**
+    @brief Initialization
+    Recovers the head of the log by a binary search, i.e. O(log(t_nofPages)) header reads.
+    A partially written record (e.g. due to a power failure during append()) is detected by its checksum and discarded
+    */
+    static void init()
+    {
+        uint8_t buffer[EEPROM::pageSize()];
+
+        readPage(0, buffer);
+        if (isValid(buffer))
+        {
+            // Page 0 is the first page of the current lap
+            recover(0, getSequence(buffer));
+            return;
+        }
+
+        // Page 0 is erased or holds a torn record, e.g. the first record of a new lap. Pages 1..t_nofPages-1 are not affected, so the head is searched starting at page 1
+        // If the head is page t_nofPages-1, the next record is appended to page 0 again
+        readPage(1, buffer);
+        if (isValid(buffer))
+        {
+            recover(1, getSequence(buffer));
+            return;
+        }
+
+        // Empty log
+        s_nextPage = 0;
+        s_nextSequence = 0;
+    }
+
+    /**
+    @brief Erase the log area
+    */
+    static void format()
+    {
+        EEPROM::erase(t_beginAddress, static_cast<uint32_t>(t_nofPages) * EEPROM::pageSize());
+        s_nextPage = 0;
+        s_nextSequence = 0;
+    }
+
+    /**
+    @brief Check if the log is empty
+    @result true if no record has been appended since format()
+    */
+    static bool isEmpty()
+    {
+        return s_nextSequence == 0;
+    }
+
+    /**
+    @brief Get the sequence number of the next record
+    @result Sequence number to be assigned by the next call of append()
+    */
+    static Sequence getNextSequence()
+    {
+        return s_nextSequence;
+    }
+
+    /**
+    @brief Append a record to the log
+    If the log is full, the oldest record will be overwritten
+    @param data Payload of the record
+    @param length Payload length (0..maxRecordSize())
+    @result false if the payload is too large
+    @note The record is written by a single page write
+    */
+    static bool append(const uint8_t * data, const uint8_t length)
+    {
+        if (length > maxRecordSize())
+        {
+            return false;
+        }
+
+        // Assemble header and payload, so the page can be written by one instruction
+        uint8_t buffer[EEPROM::pageSize()];
+        const Sequence sequence = s_nextSequence;
+        for (uint8_t idx = 0; idx < 4; ++idx)
+        {
+            buffer[HEADER_SEQUENCE + idx] = sequence >> (8 * idx);
+        }
+        buffer[HEADER_LENGTH] = length;
+
+        uint8_t * payload = buffer + HEADER_SIZE;
+        for (uint8_t idx = 0; idx < length; ++idx)
+        {
+            payload[idx] = data[idx];
+        }
+        buffer[HEADER_CHECKSUM] = getChecksum(buffer);
+
+        EEPROM::write(getPageAddress(s_nextPage), buffer, static_cast<uint8_t>(HEADER_SIZE + length));
+
+        s_nextPage = nextPage(s_nextPage);
+        ++s_nextSequence;
+
+        return true;
+    }
+
+    /**
+    @brief Replay all records from the oldest to the most recent one
+    Each record is loaded by a single multi-byte read. Records with invalid checksum are skipped
+    @param callback Callable object with signature void(Sequence sequence, const uint8_t * data, uint8_t length), executed for every record
+    */
+    static void replay(auto&& callback)
+    {
+        if (isEmpty())
+        {
+            return;
+        }
+
+        // Number of records, limited by the size of the log area
+        const Sequence nofRecords = (s_nextSequence < t_nofPages) ? s_nextSequence : t_nofPages;
+
+        // Oldest record is located nofRecords pages before the next page
+        uint16_t page = (s_nextPage >= nofRecords) ? (s_nextPage - nofRecords) : (s_nextPage + t_nofPages - nofRecords);
+
+        uint8_t buffer[EEPROM::pageSize()];
+
+        for (Sequence cnt = nofRecords; cnt > 0; --cnt)
+        {
+            readPage(page, buffer);
+            const Sequence sequence = getSequence(buffer);
+            if (isValid(buffer) && sequence == s_nextSequence - cnt)
+            {
+                callback(sequence, buffer + HEADER_SIZE, buffer[HEADER_LENGTH]);
+            }
+
+            page = nextPage(page);
+        }
+    }
+
+    private:
+
+    // Byte offsets of the record header fields. The layout is defined byte-wise, so it does not depend on the target
+    enum
+    {
+        HEADER_SEQUENCE = 0,
+        HEADER_LENGTH = 4,
+        HEADER_CHECKSUM = 5,
+        HEADER_SIZE = 6
+    };
+
+    // Sequence number of an erased page
+    static constexpr Sequence ERASED = 0xFFFFFFFF;
+
+    static constexpr typename EEPROM::Address getPageAddress(const uint16_t page)
+    {
+        return t_beginAddress + page * EEPROM::pageSize();
+    }
+
+    static constexpr uint16_t nextPage(const uint16_t page)
+    {
+        return (page + 1 < t_nofPages) ? (page + 1) : 0;
+    }
+
+    // Find the head of the log by a binary search and set up the next page/sequence number
+    // Pages lower..head have been written in the current lap and carry increasing sequence numbers starting at firstSequence
+    // Pages behind the head are either erased or carry lower sequence numbers from the previous lap
+    static void recover(const uint16_t lower, const Sequence firstSequence)
+    {
+        uint16_t head = lower;
+        uint16_t upper = t_nofPages - 1;
+        while (head < upper)
+        {
+            const uint16_t mid = upper - (upper - head) / 2;
+
+            uint8_t header[HEADER_SIZE];
+            readHeader(mid, header);
+            const Sequence sequence = getSequence(header);
+            if (sequence != ERASED && sequence >= firstSequence)
+            {
+                head = mid;
+            }
+            else
+            {
+                upper = mid - 1;
+            }
+        }
+
+        // Pages lower..head carry consecutive sequence numbers, so the sequence number of the head does not depend on its (possibly incomplete) header
+        const Sequence headSequence = firstSequence + (head - lower);
+        uint8_t buffer[EEPROM::pageSize()];
+        readPage(head, buffer);
+        if (isValid(buffer))
+        {
+            s_nextPage = nextPage(head);
+            s_nextSequence = headSequence + 1;
+        }
+        else
+        {
+            // Discard incomplete record, the next append will overwrite it
+            s_nextPage = head;
+            s_nextSequence = headSequence;
+        }
+    }
+
+    static void readHeader(const uint16_t page, uint8_t * header)
+    {
+        EEPROM::read(getPageAddress(page), header, static_cast<uint8_t>(HEADER_SIZE));
+    }
+
+    // Sequence number of a header loaded to buffer
+    static Sequence getSequence(const uint8_t * header)
+    {
+        Sequence sequence = 0;
+        for (uint8_t idx = 4; idx > 0; --idx)
+        {
+            sequence = (sequence << 8) | header[HEADER_SEQUENCE + idx - 1];
+        }
+        return sequence;
+    }
+
+    static void readPage(const uint16_t page, uint8_t * buffer)
+    {
+        EEPROM::read(getPageAddress(page), buffer, EEPROM::pageSize());
+    }
+
+    // Check header and payload of a page loaded to buffer
+    static bool isValid(const uint8_t * buffer)
+    {
+        if (getSequence(buffer) == ERASED || buffer[HEADER_LENGTH] > maxRecordSize())
+        {
+            return false;
+        }
+
+        return buffer[HEADER_CHECKSUM] == getChecksum(buffer);
+    }
+
+    // 8 bit checksum over header and payload of a page loaded to buffer. The result is never 0xFF, so an erased checksum byte is always invalid
+    static uint8_t getChecksum(const uint8_t * buffer)
+    {
+        // Sequence number and length bytes
+        uint8_t sum = 0;
+        for (uint8_t idx = 0; idx < HEADER_CHECKSUM; ++idx)
+        {
+            sum += buffer[idx];
+        }
+
+        const uint8_t * payload = buffer + HEADER_SIZE;
+        for (uint8_t idx = 0; idx < buffer[HEADER_LENGTH]; ++idx)
+        {
+            sum += payload[idx];
+        }
+
+        return (sum == 0xFF) ? 0 : sum;
+    }
+
+    static uint16_t s_nextPage;
+    static Sequence s_nextSequence;
+};
+
+// Static initialization
+template <typename EEPROM, typename EEPROM::Address t_beginAddress, uint16_t t_nofPages>
+uint16_t _25LC512_Log<EEPROM, t_beginAddress, t_nofPages>::s_nextPage = 0;
+
+// Static initialization
+template <typename EEPROM, typename EEPROM::Address t_beginAddress, uint16_t t_nofPages>
+typename _25LC512_Log<EEPROM, t_beginAddress, t_nofPages>::Sequence _25LC512_Log<EEPROM, t_beginAddress, t_nofPages>::s_nextSequence = 0;
+
+#endif
@@ -0,0 +1,222 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _25LC512_WRITE_QUEUE_H
+#define _25LC512_WRITE_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <functional.h>
+#include "ring_buffer.h"
+
+/**
+@brief Non-blocking write queue for SPI EEPROM 25AA512/25LC512
+Write requests are split into page-aligned chunks and copied to a ring buffer. The queue is drained by calling tick() periodically,
+e.g. from a timer ISR or the main loop. Each call either polls the WIP bit or programs the next page, so the CPU never waits for the internal write cycle.
+@tparam EEPROM EEPROM driver class, i.e. a specialization of _25LC512
+@tparam t_nofPages Number of pending page writes (power of two, 1..128). Each entry occupies EEPROM::pageSize() bytes of RAM plus some overhead
+@note While the queue is not idle, the EEPROM must not be accessed directly, otherwise pending data may be read back stale
+@note tick() and flush() must run in one context only. If tick() is called from an ISR, wait for isIdle() instead of calling flush()
+*/
+template <typename EEPROM, uint8_t t_nofPages = 4>
+class _25LC512_WriteQueue
+{
+    public:
+
+    /// @brief Data type for memory address/offset
+    typedef typename EEPROM::Address Address;
+
+    /// @brief Data type for completion callback
+    typedef function<void()> Callback;
+
+    /**
+    @brief Get the number of free page entries
+    @result Number of page writes which can be queued
+    */
+    static uint8_t available()
+    {
+        return s_queue.available();
+    }
+
+    /**
+    @brief Check if all queued data has been written
+    @result true if the queue is empty and the last write cycle has been finished
+    */
+    static bool isIdle()
+    {
+        return s_queue.empty();
+    }
+
+    /**
+    @brief Queue multiple Bytes to be written to EEPROM starting at given position
+    @param address Position of first byte in EEPROM (0..65535)
+    @param data Bytes to be written to EEPROM. Data is copied, so the buffer can be re-used immediately
+    @param nofBytes Number of Bytes to be written to EEPROM
+    @result false if there are not enough free entries in the queue. In this case, nothing will be written
+    */
+    template <typename Length>
+    static bool write(const Address address, const uint8_t * data, const Length nofBytes)
+    {
+        return enqueue(address, data, nofBytes, nullptr);
+    }
+
+    /**
+    @brief Queue multiple Bytes to be written to EEPROM starting at given position
+    @param address Position of first byte in EEPROM (0..65535)
+    @param data Bytes to be written to EEPROM. Data is copied, so the buffer can be re-used immediately
+    @param nofBytes Number of Bytes to be written to EEPROM
+    @param callback Callback to be executed from tick() after the write cycle of the last page has been finished
+    @result false if there are not enough free entries in the queue. In this case, nothing will be written and the callback will not be executed
+    */
+    template <typename Length>
+    static bool write(const Address address, const uint8_t * data, const Length nofBytes, auto&& callback)
+    {
+        Callback completion(callback);
+        return enqueue(address, data, nofBytes, &completion);
+    }
+
+    /**
+    @brief Drain the queue in the background
+    This method has to be called periodically, e.g. from a timer ISR. Execution time is bounded by one page transfer
+    */
+    static void tick()
+    {
+        if (s_queue.empty())
+        {
+            return;
+        }
+
+        // Wait for the write cycle (of the front entry or any previous synchronous write) to finish
+        if (EEPROM::isBusy())
+        {
+            return;
+        }
+
+        if (s_programming)
+        {
+            // Write cycle of the front entry has been finished
+            Entry & entry = s_queue.front();
+            s_programming = false;
+            if (entry.notify)
+            {
+                entry.callback();
+            }
+            s_queue.pop();
+
+            if (s_queue.empty())
+            {
+                return;
+            }
+        }
+
+        // Start programming the next page
+        const Entry & entry = s_queue.front();
+        EEPROM::programPage(entry.address, entry.data, entry.nofBytes);
+        s_programming = true;
+    }
+
+    /**
+    @brief Wait until all queued data has been written
+    The queue is drained by calling tick() from the caller's context
+    @note Must not be used if tick() is called from an ISR, as both calls could then program the same page or execute the same callback. Poll isIdle() instead
+    */
+    static void flush()
+    {
+        while (!isIdle())
+        {
+            tick();
+        }
+    }
+
+    private:
+
+    // Pending page write
+    struct Entry
+    {
+        Address address;
+        uint8_t nofBytes;
+        bool notify;
+        Callback callback;
+        uint8_t data[EEPROM::pageSize()];
+    };
+
+    // Split data into page-aligned entries. The callback (if any) is attached to the last entry
+    template <typename Length>
+    static bool enqueue(Address address, const uint8_t * data, Length nofBytes, const Callback * callback)
+    {
+        // Count the number of entries needed before queuing anything
+        const uint8_t nofAvailable = s_queue.available();
+        uint8_t nofEntries = 0;
+        {
+            Address chunkAddress = address;
+            Length remaining = nofBytes;
+            while (remaining > 0)
+            {
+                if (nofEntries == nofAvailable)
+                {
+                    return false;
+                }
+
+                const uint8_t chunkSize = EEPROM::getChunkSize(chunkAddress, remaining);
+                chunkAddress += chunkSize;
+                remaining -= chunkSize;
+                ++nofEntries;
+            }
+        }
+
+        for (uint8_t entryIdx = 0; entryIdx < nofEntries; ++entryIdx)
+        {
+            const uint8_t chunkSize = EEPROM::getChunkSize(address, nofBytes);
+            const bool last = (entryIdx + 1 == nofEntries);
+
+            Entry & entry = s_queue.back(entryIdx);
+            entry.address = address;
+            entry.nofBytes = chunkSize;
+            entry.notify = last && (callback != nullptr);
+            if (entry.notify)
+            {
+                entry.callback = *callback;
+            }
+
+            for (uint8_t idx = 0; idx < chunkSize; ++idx)
+            {
+                entry.data[idx] = *data++;
+            }
+
+            address += chunkSize;
+            nofBytes -= chunkSize;
+        }
+
+        // Commit all entries at once, so tick() never sees a partially queued request
+        s_queue.commit(nofEntries);
+
+        return true;
+    }
+
+    static RingBuffer<Entry, t_nofPages> s_queue;
+    static volatile bool s_programming;
+};
+
+// Static initialization
+template <typename EEPROM, uint8_t t_nofPages>
+RingBuffer<typename _25LC512_WriteQueue<EEPROM, t_nofPages>::Entry, t_nofPages> _25LC512_WriteQueue<EEPROM, t_nofPages>::s_queue;
+
+// Static initialization
+template <typename EEPROM, uint8_t t_nofPages>
+volatile bool _25LC512_WriteQueue<EEPROM, t_nofPages>::s_programming = false;
+
+#endif
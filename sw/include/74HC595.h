@@ -42,6 +42,15 @@ class _74HC595
         return t_nofDevices;
     }
 
+    /**
+    @brief Get the maximum SPI clock of the device
+    @result Maximum SPI clock in Hz
+    */
+    static constexpr uint32_t getMaxSPIClock()
+    {
+        return _74HC595_MAX_SPI_CLOCK;
+    }
+
     /**
     @brief Put data to device
     @param data Data to be sent to device
@@ -98,6 +107,15 @@ class _74HC595<SPIMaster, SSPin, 1>
         return 1;
     }
 
+    /**
+    @brief Get the maximum SPI clock of the device
+    @result Maximum SPI clock in Hz
+    */
+    static constexpr uint32_t getMaxSPIClock()
+    {
+        return _74HC595_MAX_SPI_CLOCK;
+    }
+
     /**
     @brief Put data to device
     @param data Data to be sent to device
@@ -22,10 +22,20 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #define DSPIC33_MAX_SPI_CLOCK 10000000UL // 10 MHz
 
+// Block transfer frame: Prefix word (DSPIC33_BLOCK_PREFIX, command), address word, word count, data words, optional checksum word
+#define DSPIC33_BLOCK_PREFIX 0xFF // Parameter address reserved for block transfers
+#define DSPIC33_COMMAND_WRITE 0x01 // Data words are written to DSP
+#define DSPIC33_COMMAND_READ 0x02 // Data words are read from DSP
+#define DSPIC33_COMMAND_EXCHANGE 0x03 // Data words are written to and read from DSP simultaneously
+#define DSPIC33_COMMAND_CHECKSUM 0x80 // Frame is terminated by a checksum word
+
 /**
-@brief Driver for 8 bit parameter transfer to dsPIC33 via SPI
-@tparam SPIMaster SPI master driver class implementing static methods put(uint8_t)
+@brief Driver for 8 bit parameter transfer and 16 bit block transfer to/from dsPIC33 via SPI
+Block transfers send a sequence of 16 bit words (MSB first) in one SS cycle. The dsPIC33 shifts out its read data at the same time (full-duplex), starting with the first data word.
+If enabled, the last word of a frame is the checksum, i.e. the 16 bit sum of all data words. Both sides send the checksum of the data words they have sent.
+@tparam SPIMaster SPI master driver class implementing static methods put(uint8_t), put(const uint8_t*, uint16_t) and get(). Read-back via exchangeBlock() additionally needs transfer(uint8_t), which sends a byte and returns the byte received at the same time
 @tparam SSPin Pin driver class implementing static methods high() and low()
+@note Parameter address DSPIC33_BLOCK_PREFIX is reserved for block transfers
  */
 template <
 typename SPIMaster,
@@ -34,9 +44,18 @@ class DSPIC33
 {
     public:
 
+    /**
+    @brief Get the maximum SPI clock of the device
+    @result Maximum SPI clock in Hz
+    */
+    static constexpr uint32_t getMaxSPIClock()
+    {
+        return DSPIC33_MAX_SPI_CLOCK;
+    }
+
     /**
     @brief Write a parameter to DSP
-    @param address Address of parameter to be sent to device
+    @param address Address of parameter to be sent to device (0..0xFE). Address DSPIC33_BLOCK_PREFIX is reserved for block transfers
     @param value Value of parameter to be sent to device
     @note Address byte + data byte will be handled as one 16 bit word on the dsPIC33, so access to a received parameter will always be atomic
     */
@@ -54,6 +73,157 @@ class DSPIC33
         // Disable device (active low)
         SSPin::high();
     }
+
+    /**
+    @brief Write several parameters to DSP in one transfer
+    @param data Address/value pairs of parameters to be sent to device, i.e. address of first parameter, value of first parameter, address of second parameter, ... Addresses must not be DSPIC33_BLOCK_PREFIX, which is reserved for block transfers
+    @param nofParameters Number of parameters
+    @note The dsPIC33 handles back-to-back 16 bit words, so one SS cycle is sufficient. Make sure data has sufficient length of 2 * nofParameters bytes!
+    */
+    static void writeBurst(const uint8_t * const data, const uint8_t nofParameters)
+    {
+        // Enable device (active low)
+        SSPin::low();
+
+        // Transfer address/value pairs
+        SPIMaster::put(data, 2 * nofParameters);
+
+        // Disable device (active low)
+        SSPin::high();
+    }
+
+    /**
+    @brief Write a 16 bit parameter to DSP
+    @param address Address of parameter in block address space
+    @param value Value of parameter
+    */
+    static void write16(const uint16_t address, const uint16_t value)
+    {
+        writeBlock(address, &value, 1);
+    }
+
+    /**
+    @brief Write a block of 16 bit words to DSP, e.g. a wavetable or filter coefficients
+    @param address Start address of block
+    @param data Data to be sent to device
+    @param nofWords Number of words
+    @param checksum Append a checksum, which is verified by the DSP
+    */
+    static void writeBlock(const uint16_t address, const uint16_t * const data, const uint16_t nofWords, const bool checksum = false)
+    {
+        transferBlock<DSPIC33_COMMAND_WRITE>(address, data, nullptr, nofWords, checksum);
+    }
+
+    /**
+    @brief Read a block of 16 bit words from DSP, e.g. meter values
+    @param address Start address of block
+    @param data Buffer for data received from device
+    @param nofWords Number of words
+    @param checksum Request a checksum from the DSP
+    @result false if the checksum does not match. Always true without checksum
+    */
+    static bool readBlock(const uint16_t address, uint16_t * const data, const uint16_t nofWords, const bool checksum = false)
+    {
+        return transferBlock<DSPIC33_COMMAND_READ>(address, nullptr, data, nofWords, checksum);
+    }
+
+    /**
+    @brief Write and read a block of 16 bit words in one full-duplex transfer, e.g. write parameters and read back meter values
+    @param address Start address of block
+    @param txData Data to be sent to device
+    @param rxData Buffer for data received from device. May be identical to txData
+    @param nofWords Number of words
+    @param checksum Append a checksum in both directions
+    @result false if the checksum of the received data does not match. Always true without checksum
+    */
+    static bool exchangeBlock(const uint16_t address, const uint16_t * const txData, uint16_t * const rxData, const uint16_t nofWords, const bool checksum = false)
+    {
+        return transferBlock<DSPIC33_COMMAND_EXCHANGE>(address, txData, rxData, nofWords, checksum);
+    }
+
+    private:
+
+    template <uint8_t t_command>
+    static bool transferBlock(const uint16_t address, const uint16_t * txData, uint16_t * rxData, const uint16_t nofWords, const bool checksum)
+    {
+        uint16_t txSum = 0;
+        uint16_t rxSum = 0;
+
+        // Enable device (active low)
+        SSPin::low();
+
+        // Transfer header
+        SPIMaster::put(DSPIC33_BLOCK_PREFIX);
+        SPIMaster::put(t_command | (checksum ? DSPIC33_COMMAND_CHECKSUM : 0));
+        putWord(address);
+        putWord(nofWords);
+
+        // Transfer data words
+        for (uint16_t idx = 0; idx < nofWords; ++idx)
+        {
+            if constexpr (t_command == DSPIC33_COMMAND_WRITE)
+            {
+                const uint16_t value = *txData++;
+                putWord(value);
+                txSum += value;
+            }
+            else if constexpr (t_command == DSPIC33_COMMAND_READ)
+            {
+                const uint16_t value = getWord();
+                *rxData++ = value;
+                rxSum += value;
+            }
+            else
+            {
+                const uint16_t txValue = *txData++;
+                const uint16_t rxValue = transferWord(txValue);
+                *rxData++ = rxValue;
+                txSum += txValue;
+                rxSum += rxValue;
+            }
+        }
+
+        // Transfer checksum. A checksum of written data is verified by the DSP
+        bool valid = true;
+        if (checksum)
+        {
+            if constexpr (t_command == DSPIC33_COMMAND_WRITE)
+            {
+                putWord(txSum);
+            }
+            else if constexpr (t_command == DSPIC33_COMMAND_READ)
+            {
+                valid = (getWord() == rxSum);
+            }
+            else
+            {
+                valid = (transferWord(txSum) == rxSum);
+            }
+        }
+
+        // Disable device (active low)
+        SSPin::high();
+
+        return valid;
+    }
+
+    static void putWord(const uint16_t value) __attribute__((always_inline))
+    {
+        SPIMaster::put(value >> 8);
+        SPIMaster::put(value & 0xFF);
+    }
+
+    static uint16_t getWord() __attribute__((always_inline))
+    {
+        const uint8_t high = SPIMaster::get();
+        return (high << 8) | SPIMaster::get();
+    }
+
+    static uint16_t transferWord(const uint16_t value) __attribute__((always_inline))
+    {
+        const uint8_t high = SPIMaster::transfer(value >> 8);
+        return (high << 8) | SPIMaster::transfer(value & 0xFF);
+    }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,172 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef DSPIC33_PARAMETERS_H
+#define DSPIC33_PARAMETERS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "DSPIC33.h"
+
+/**
+@brief Coalescing parameter table for DSPIC33
+Parameters are written to a RAM table and marked as dirty. flush() only transfers dirty parameters, so any number of updates of one parameter between two flushes results in a single transfer.
+Dirty parameters are collected and sent as bursts of up to t_burstLength parameters per SS cycle.
+@tparam DSP DSP driver class, i.e. a specialization of DSPIC33
+@tparam t_nofParameters Number of parameters (1..255). Parameter addresses are 0..t_nofParameters-1, as address DSPIC33_BLOCK_PREFIX (0xFF) is reserved for block transfers
+@tparam t_burstLength Maximum number of parameters per SS cycle (1..127). The burst is buffered on the stack, so it needs 2 * t_burstLength bytes
+@note set() and flush() must not interrupt each other, e.g. call both from the main loop
+*/
+template <typename DSP, uint16_t t_nofParameters, uint8_t t_burstLength = 8>
+class DSPIC33_ParameterTable
+{
+    static_assert(t_nofParameters > 0 && t_nofParameters <= DSPIC33_BLOCK_PREFIX, "Number of parameters must be in the range 1..255");
+    static_assert(t_burstLength > 0 && t_burstLength <= 127, "Burst length must be in the range 1..127");
+
+    public:
+
+    /**
+    @brief Get the number of parameters
+    @result Number of parameters
+    */
+    static constexpr uint16_t getNofParameters()
+    {
+        return t_nofParameters;
+    }
+
+    /**
+    @brief Set a parameter. It is transferred on the next flush() if its value has changed
+    @param address Address of parameter (0..t_nofParameters-1)
+    @param value Value of parameter
+    */
+    static void set(const uint8_t address, const uint8_t value)
+    {
+        if (s_values[address] != value)
+        {
+            s_values[address] = value;
+            s_dirty[address >> 3] |= _BV(address & 0b111);
+        }
+    }
+
+    /**
+    @brief Get the latest value of a parameter
+    @param address Address of parameter (0..t_nofParameters-1)
+    @result Value of parameter
+    */
+    static uint8_t get(const uint8_t address)
+    {
+        return s_values[address];
+    }
+
+    /**
+    @brief Check if any parameter has not been transferred yet
+    @result true if flush() would transfer data
+    */
+    static bool isDirty()
+    {
+        for (uint8_t idx = 0; idx < getNofDirtyBytes(); ++idx)
+        {
+            if (s_dirty[idx] != 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+    @brief Transfer all dirty parameters to DSP
+    @result Number of parameters transferred
+    */
+    static uint16_t flush()
+    {
+        uint8_t burst[2 * t_burstLength];
+        uint8_t nofBurst = 0;
+        uint16_t nofTransfers = 0;
+
+        for (uint8_t idx = 0; idx < getNofDirtyBytes(); ++idx)
+        {
+            uint8_t dirty = s_dirty[idx];
+
+            // Whole groups of 8 clean parameters are skipped at once
+            if (dirty == 0)
+            {
+                continue;
+            }
+
+            s_dirty[idx] = 0;
+
+            for (uint8_t address = idx << 3; dirty != 0; ++address, dirty >>= 1)
+            {
+                if (!(dirty & 1))
+                {
+                    continue;
+                }
+
+                burst[2 * nofBurst] = address;
+                burst[2 * nofBurst + 1] = s_values[address];
+                ++nofTransfers;
+
+                if (++nofBurst == t_burstLength)
+                {
+                    DSP::writeBurst(burst, nofBurst);
+                    nofBurst = 0;
+                }
+            }
+        }
+
+        if (nofBurst > 0)
+        {
+            DSP::writeBurst(burst, nofBurst);
+        }
+
+        return nofTransfers;
+    }
+
+    /**
+    @brief Mark all parameters as dirty, e.g. after a reset of the DSP
+    */
+    static void invalidate()
+    {
+        for (uint16_t address = 0; address < t_nofParameters; ++address)
+        {
+            s_dirty[address >> 3] |= _BV(address & 0b111);
+        }
+    }
+
+    private:
+
+    static constexpr uint8_t getNofDirtyBytes()
+    {
+        return (t_nofParameters + 7) / 8;
+    }
+
+    typedef uint8_t DirtyBits[getNofDirtyBytes()];
+
+    static uint8_t s_values[t_nofParameters]; // Latest values of all parameters
+    static DirtyBits s_dirty; // Bit n of byte m is set if parameter 8 * m + n has not been transferred yet
+};
+
+// Static initialization
+template <typename DSP, uint16_t t_nofParameters, uint8_t t_burstLength>
+uint8_t DSPIC33_ParameterTable<DSP, t_nofParameters, t_burstLength>::s_values[t_nofParameters];
+
+// Static initialization
+template <typename DSP, uint16_t t_nofParameters, uint8_t t_burstLength>
+typename DSPIC33_ParameterTable<DSP, t_nofParameters, t_burstLength>::DirtyBits DSPIC33_ParameterTable<DSP, t_nofParameters, t_burstLength>::s_dirty;
+
+#endif
@@ -22,8 +22,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <stdbool.h>
 #include <util/delay.h>
 #include <avr/pgmspace.h>
-#include "memcopy.h"
 #include "div.h"
+#include "74HC595.h"
 
 // LCD routines need correct CPU clock for proper timing
 #ifndef F_CPU
@@ -31,11 +31,24 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #define F_CPU 16000000UL
 #endif
 
+// Execution time of most commands and data writes in us, including address counter update. Datasheet specifies 37 us + 4 us at 270 kHz
+#ifndef HD44780_EXECUTION_TIME_US
+#define HD44780_EXECUTION_TIME_US 41
+#endif
+
+// Execution time of clear display and return home commands in us. Datasheet specifies 1.52 ms at 270 kHz
+#ifndef HD44780_EXECUTION_TIME_LONG_US
+#define HD44780_EXECUTION_TIME_LONG_US 1520
+#endif
+
 ///@brief Number of characters controlled by HD44780 device
 enum class HD44780_NofCharacters : uint8_t
 {
     _1x16,
-    _2x16
+    _2x16,
+    _2x20,
+    _4x20,
+    _4x40
 };
 
 /**
@@ -47,11 +60,19 @@ template <HD44780_NofCharacters t_nofCharacter>
 struct HD44780_Configuration;
 
 /**
-@brief HD44780 Configuration for 2x16 display
+@brief Common implementation of HD44780 display configurations
+All methods are constexpr, so e.g. setCursor() with constant arguments results in a single immediate command
+@tparam t_nofRows Number of display rows
+@tparam t_nofColumns Number of display columns
+@tparam t_nofControllers Number of HD44780 controllers (i.e. EN lines), each driving the same number of rows (1..2)
 */
-template <>
-class HD44780_Configuration<HD44780_NofCharacters::_2x16>
+template <uint8_t t_nofRows, uint8_t t_nofColumns, uint8_t t_nofControllers = 1>
+class HD44780_ConfigurationBase
 {
+    static_assert(t_nofControllers == 1 || t_nofControllers == 2, "Invalid number of controllers");
+    static_assert(t_nofRows % t_nofControllers == 0, "Rows must be distributed equally to controllers");
+    static_assert(t_nofRows / t_nofControllers <= 4 && t_nofColumns * ((t_nofRows / t_nofControllers + 1) / 2) <= 40, "Display exceeds DDRAM size of one controller");
+
     protected:
     
     /**
@@ -60,7 +81,7 @@ class HD44780_Configuration<HD44780_NofCharacters::_2x16>
     */
     static constexpr uint8_t getNofRows()
     {
-        return 2;
+        return t_nofRows;
     }
 
     /**
@@ -69,18 +90,38 @@ class HD44780_Configuration<HD44780_NofCharacters::_2x16>
     */
     static constexpr uint8_t getNofColumns()
     {
-        return 16;
+        return t_nofColumns;
+    }
+
+    /**
+    @brief Get number of HD44780 controllers
+    @result Number of HD44780 controllers, i.e. EN lines
+    */
+    static constexpr uint8_t getNofControllers()
+    {
+        return t_nofControllers;
     }
 
     /**
     @brief Get address offset for given row
-    @param row Selected row (0..1)
-    @result Address offset for selected row
+    Rows 0 and 1 start at DDRAM address 0x00 and 0x40. Rows 2 and 3 continue those lines behind the last column
+    @param row Selected row (0..t_nofRows-1)
+    @result Address offset for selected row within its controller
+    */
+    static constexpr uint8_t getRowAddress(const uint8_t row)
+    {
+        const uint8_t line = row % getNofRowsPerController();
+        return ((line & 0b01) ? 0x40 : 0x00) + ((line & 0b10) ? t_nofColumns : 0);
+    }
+
+    /**
+    @brief Get controller selection for given row
+    @param row Selected row (0..t_nofRows-1)
+    @result Bit mask of the controller driving the selected row (bit 0: first controller, bit 1: second controller)
     */
-    static uint8_t getRowAddress(const uint8_t row)
+    static constexpr uint8_t getControllerMask(const uint8_t row)
     {
-        static const uint8_t rowAddress[2] PROGMEM = {0x00, 0x40};
-        return memread_P(&rowAddress[row]);
+        return 1 << (row / getNofRowsPerController());
     }
     
     /**
@@ -89,18 +130,71 @@ class HD44780_Configuration<HD44780_NofCharacters::_2x16>
     */
     static constexpr uint8_t getNofRowsControlWord()
     {
-        return 0x08; // 2 rows
+        return (getNofRowsPerController() > 1) ? 0x08 : 0x00; // 2 lines or 1 line
+    }
+
+    private:
+
+    static constexpr uint8_t getNofRowsPerController()
+    {
+        return t_nofRows / t_nofControllers;
     }
 };
 
+/**
+@brief HD44780 Configuration for 1x16 display
+@note Some 1x16 modules are internally organized as 2x8. Such modules have to be used as 2x16 display
+*/
+template <>
+struct HD44780_Configuration<HD44780_NofCharacters::_1x16> : HD44780_ConfigurationBase<1, 16>
+{};
+
+/**
+@brief HD44780 Configuration for 2x16 display
+*/
+template <>
+struct HD44780_Configuration<HD44780_NofCharacters::_2x16> : HD44780_ConfigurationBase<2, 16>
+{};
+
+/**
+@brief HD44780 Configuration for 2x20 display
+*/
+template <>
+struct HD44780_Configuration<HD44780_NofCharacters::_2x20> : HD44780_ConfigurationBase<2, 20>
+{};
+
+/**
+@brief HD44780 Configuration for 4x20 display
+*/
+template <>
+struct HD44780_Configuration<HD44780_NofCharacters::_4x20> : HD44780_ConfigurationBase<4, 20>
+{};
+
+/**
+@brief HD44780 Configuration for 4x40 display
+This display consists of two controllers, each driving two rows. The port needs to provide two EN lines
+*/
+template <>
+struct HD44780_Configuration<HD44780_NofCharacters::_4x40> : HD44780_ConfigurationBase<4, 40, 2>
+{};
+
+/**
+@brief Placeholder for optional pins not connected to the display (e.g. R/W pin tied to ground)
+*/
+struct HD44780_NoPin {};
+
 /**
 @brief Low-level driver for HD44780 LCD controller in 4 bit mode connected to a GPIO port.
 This class contains all methods to configure and use the port.
+If the R/W pin of the display is connected, the busy flag is polled before each transfer, so the CPU only waits as long as the controller is actually busy.
+Otherwise, the worst-case execution time of each command is waited
 @tparam PB_Port Driver for any 4-pin GPIO_SubPort connected to data port pins D4:7 of the display
 @tparam EN_Pin Driver for any GPIO_Pin connected to EN pin of the display
 @tparam RS_Pin Driver for any GPIO_Pin connected to RS pin of the display
+@tparam RW_Pin Driver for any GPIO_Pin connected to R/W pin of the display or HD44780_NoPin, if R/W is tied to ground
+@tparam EN2_Pin Driver for any GPIO_Pin connected to the second EN pin of displays with two controllers (e.g. 4x40) or HD44780_NoPin
 */
-template <typename PB_Port, typename EN_Pin, typename RS_Pin>
+template <typename PB_Port, typename EN_Pin, typename RS_Pin, typename RW_Pin = HD44780_NoPin, typename EN2_Pin = HD44780_NoPin>
 class HD44780_ParallelPort
 {
     protected:
@@ -110,17 +204,9 @@ class HD44780_ParallelPort
     */
     static void init()
     {
-        // Use control pins as outputs
-        PB_Port::set_as_output();
-        EN_Pin::set_as_output();
-        RS_Pin::set_as_output();
-        
-        // clear all outputs
-        PB_Port::write(0);
-        EN_Pin::low();
-        RS_Pin::low();
+        initPins();
         
-        // Init the actual LCD controller
+        // Init the actual LCD controller. Busy flag cannot be checked until 4-bit mode has been set
         
         // Wait 15 ms until LCD is ready
         _delay_ms(15);
@@ -138,17 +224,58 @@ class HD44780_ParallelPort
         _delay_ms(5);
     }
 
+    /**
+    @brief Initialization of control and data pins only, without LCD controller initialization
+    */
+    static void initPins()
+    {
+        // Use control pins as outputs
+        PB_Port::set_as_output();
+        EN_Pin::set_as_output();
+        RS_Pin::set_as_output();
+        if constexpr (hasRWPin())
+        {
+            RW_Pin::set_as_output();
+        }
+        if constexpr (hasEN2Pin())
+        {
+            EN2_Pin::set_as_output();
+        }
+        
+        // clear all outputs
+        PB_Port::write(0);
+        setEnable(0);
+        RS_Pin::low();
+        if constexpr (hasRWPin())
+        {
+            RW_Pin::low();
+        }
+    }
+
+    /**
+    @brief Select the controllers addressed by subsequent transfers (displays with two controllers only)
+    @param controllerMask Bit mask of selected controllers (bit 0: EN_Pin, bit 1: EN2_Pin). Commands can be sent to both controllers at once
+    */
+    static void selectControllers(const uint8_t controllerMask)
+    {
+        s_controllerMask = controllerMask & getAllControllers();
+    }
+
     /**
     @brief Send a data byte to the LCD
     @param data Data byte to be sent to LCD
     */
     static void writeData(const uint8_t data)
     {
+        waitWhileBusy();
+        
         // RS = 1 for data
         write8Bit(data, true);
         
-        // 46us delay
-        _delay_us(46);
+        if constexpr (!hasRWPin())
+        {
+            _delay_us(HD44780_EXECUTION_TIME_US);
+        }
     }
 
     /**
@@ -157,23 +284,157 @@ class HD44780_ParallelPort
     */
     static void writeCommand(const uint8_t command)
     {
+        waitWhileBusy();
+        
         // RS = 0 for command
         write8Bit(command, false);
         
-        // 42us delay
-        _delay_us(42);
+        if constexpr (!hasRWPin())
+        {
+            if (command < 0x04)
+            {
+                // Clear display and return home
+                _delay_us(HD44780_EXECUTION_TIME_LONG_US);
+            }
+            else
+            {
+                _delay_us(HD44780_EXECUTION_TIME_US);
+            }
+        }
+    }
+
+    /**
+    @brief Send upper nibble of a command byte to the LCD without waiting for its execution
+    @param data Byte whose upper nibble is sent to LCD
+    */
+    static void writeNibble(const uint8_t data)
+    {
+        // RS = 0 for command
+        RS_Pin::low();
+        write4Bit(data);
+    }
+
+    /**
+    @brief Send a byte to the LCD without waiting for its execution
+    @param data Byte to be sent to LCD
+    @param RS flag indicating if RS pin should be driven high (data) or low (command)
+    */
+    static void writeByte(const uint8_t data, const bool RS)
+    {
+        write8Bit(data, RS);
     }
 
     private:
 
+    /**
+    @brief Check if the R/W pin is connected
+    @result true if busy flag can be read
+    */
+    static constexpr bool hasRWPin()
+    {
+        return requires { RW_Pin::high(); };
+    }
+
+    /**
+    @brief Check if a second EN pin is connected
+    @result true if the display consists of two controllers
+    */
+    static constexpr bool hasEN2Pin()
+    {
+        return requires { EN2_Pin::high(); };
+    }
+
+    /**
+    @brief Get the bit mask of all connected controllers
+    @result Bit mask of all controllers
+    */
+    static constexpr uint8_t getAllControllers()
+    {
+        return hasEN2Pin() ? 0b11 : 0b01;
+    }
+
+    /**
+    @brief Drive EN pins
+    @param controllerMask Bit mask of controllers whose EN pin is driven high. All other EN pins are driven low
+    */
+    static void setEnable(const uint8_t controllerMask) __attribute__((always_inline))
+    {
+        if (controllerMask & 0b01)
+        {
+            EN_Pin::high();
+        }
+        else
+        {
+            EN_Pin::low();
+        }
+        
+        if constexpr (hasEN2Pin())
+        {
+            if (controllerMask & 0b10)
+            {
+                EN2_Pin::high();
+            }
+            else
+            {
+                EN2_Pin::low();
+            }
+        }
+    }
+
+    /**
+    @brief Wait until the busy flag is cleared
+    @note Without R/W pin, this method returns immediately
+    */
+    static void waitWhileBusy()
+    {
+        if constexpr (hasRWPin())
+        {
+            // Read busy flag and address counter (RS = 0, R/W = 1)
+            PB_Port::set_as_input();
+            RS_Pin::low();
+            RW_Pin::high();
+            
+            // Busy flag has to be read from each selected controller separately
+            for (uint8_t controller = 0b01; controller <= getAllControllers(); controller <<= 1)
+            {
+                if (!(s_controllerMask & controller))
+                {
+                    continue;
+                }
+                
+                bool busy;
+                do
+                {
+                    // Busy flag is D7 of upper nibble
+                    setEnable(controller);
+                    _delay_us(0.5); // Data delay time is 360 ns
+                    busy = PB_Port::read() & 0b1000;
+                    setEnable(0);
+                    _delay_us(0.5); // Enable cycle time is 1 us
+                    
+                    // Lower nibble of address counter is discarded
+                    setEnable(controller);
+                    _delay_us(0.45); // Enable pulse width is 450 ns
+                    setEnable(0);
+                    _delay_us(0.55); // Enable cycle time is 1 us
+                }
+                while (busy);
+            }
+            
+            RW_Pin::low();
+            PB_Port::set_as_output();
+        }
+    }
+
     /**
     @brief Create an Enable pulse
     */
     static void writeEnable()
     {
-        EN_Pin::high();
-        _delay_us(20); // Enable pulse is 20 us
-        EN_Pin::low();
+        setEnable(s_controllerMask);
+        _delay_us(0.45); // Enable pulse width is 450 ns
+        setEnable(0);
+        _delay_us(0.55); // Enable cycle time is 1 us
     }
     
     /**
@@ -204,17 +465,46 @@ class HD44780_ParallelPort
         write4Bit(data);
         write4Bit(data << 4);
     }
+
+    // Controllers addressed by transfers
+    static uint8_t s_controllerMask;
 };
 
+// Static initialization
+template <typename PB_Port, typename EN_Pin, typename RS_Pin, typename RW_Pin, typename EN2_Pin>
+uint8_t HD44780_ParallelPort<PB_Port, EN_Pin, RS_Pin, RW_Pin, EN2_Pin>::s_controllerMask = HD44780_ParallelPort<PB_Port, EN_Pin, RS_Pin, RW_Pin, EN2_Pin>::getAllControllers();
+
 /**
-@brief Low-level driver for configuration of an HD44780 LCD controller in 4 bit mode connected to a 74HC595 8bit serial --> parallel shift register
-This class contains all methods to configure and use the port.
+@brief Low-level driver for an HD44780 LCD controller in 4 bit mode connected to a 74HC595 8bit serial --> parallel shift register, including the EN pin
+The EN pin of the display is driven by a 74HC595 output and SS_Pin only latches the shift register.
+So each edge of the enable pulse is one SPI transfer at full SPI speed without any delay. The duration of one SPI transfer (at least 8 SPI clock cycles) always exceeds the minimum enable pulse width of 450 ns.
+RS is only set up by a separate transfer if it changes, so a byte transfer takes 4 (or 5) SPI transfers.
+The backlight bit is held in a shadow register, so it keeps its state during transfers.
 @tparam SPIMaster Any SPI master driver implementing a static put() method
-@tparam SS_Pin Any output pin driver implementing stating low() and high() methods
+@tparam SS_Pin Any output pin driver implementing stating low() and high() methods, connected to the storage register clock (RCLK) of the 74HC595
+@tparam t_ENBit 74HC595 output connected to EN pin of the display (0..7)
+@tparam t_RSBit 74HC595 output connected to RS pin of the display (0..7)
+@tparam t_backlightBit 74HC595 output connected to the backlight driver (0..7)
+@tparam t_DBShift First of four consecutive 74HC595 outputs connected to data port pins D4:7 of the display (0..4)
 */
-template <typename SPIMaster, typename SS_Pin>
-class HD44780_Configuration_74HC595
+template <typename SPIMaster, typename SS_Pin, uint8_t t_ENBit = 0, uint8_t t_RSBit = 2, uint8_t t_backlightBit = 3, uint8_t t_DBShift = 4>
+class HD44780_74HC595_Port
 {
+    static_assert(t_ENBit < 8 && t_RSBit < 8 && t_backlightBit < 8 && t_DBShift <= 4, "Invalid 74HC595 output");
+    static_assert(((_BV(t_ENBit) | _BV(t_RSBit) | _BV(t_backlightBit)) & (0x0F << t_DBShift)) == 0, "74HC595 outputs must not overlap the data pins");
+    static_assert(t_ENBit != t_RSBit && t_ENBit != t_backlightBit && t_RSBit != t_backlightBit, "74HC595 outputs must be unique");
+
+    public:
+
+    /**
+    @brief Get the maximum SPI clock of the device
+    @result Maximum SPI clock in Hz
+    */
+    static constexpr uint32_t getMaxSPIClock()
+    {
+        return _74HC595_MAX_SPI_CLOCK;
+    }
+
     protected:
 
     /**
@@ -223,22 +513,35 @@ class HD44780_Configuration_74HC595
     */
     static void init()
     {
+        initPins();
+        
         // Wait 15 ms until LCD is ready
         _delay_ms(15);
         
         // Send soft reset three times
-        write4Bit(0x30);
+        writeNibble(0x30);
         _delay_ms(5);
-        writeEnable();
+        writeNibble(0x30);
         _delay_ms(1);
-        writeEnable();
+        writeNibble(0x30);
         _delay_ms(1);
         
         // Enable 4-bit mode
-        write4Bit(0x20);
+        writeNibble(0x20);
         _delay_ms(5);
     }
 
+    /**
+    @brief Initialization of the shift register outputs only, without LCD controller initialization
+    @note SPIMaster and SS_Pin drivers have to be initialized beforehand
+    */
+    static void initPins()
+    {
+        // EN and RS low, backlight unchanged
+        s_state &= _BV(t_backlightBit);
+        shift(s_state);
+    }
+
     /**
     @brief Send a data byte to LCD
     @param data Data byte to be sent to LCD
@@ -246,90 +549,118 @@ class HD44780_Configuration_74HC595
     static void writeData(const uint8_t data)
     {
         // RS = 1 for data
-        write8Bit(data, true);
+        writeByte(data, true);
         
-        // 46us delay
-        _delay_us(46);
+        _delay_us(HD44780_EXECUTION_TIME_US);
     }
 
     /**
     @brief Send a command byte to LCD
-    @param data Command byte to be sent to LCD
+    @param command Command byte to be sent to LCD
     */
-    static void writeCommand(const uint8_t data)
+    static void writeCommand(const uint8_t command)
     {
         // RS = 0 for command
-        write8Bit(data, false);
+        writeByte(command, false);
         
-        // 42us delay
-        _delay_us(42);
+        if (command < 0x04)
+        {
+            // Clear display and return home
+            _delay_us(HD44780_EXECUTION_TIME_LONG_US);
+        }
+        else
+        {
+            _delay_us(HD44780_EXECUTION_TIME_US);
+        }
     }
 
-    private:
+    /**
+    @brief Send upper nibble of a command byte to the LCD without waiting for its execution
+    @param data Byte whose upper nibble is sent to LCD
+    */
+    static void writeNibble(const uint8_t data)
+    {
+        // RS = 0 for command
+        setRS(false);
+        write4Bit(data >> 4);
+    }
 
     /**
-    @brief Send an Enable pulse to LCD
+    @brief Send a byte to the LCD without waiting for its execution
+    @param data Byte to be sent to LCD
+    @param RS flag indicating if RS pin should be driven high (data) or low (command)
     */
-    static void writeEnable()
+    static void writeByte(const uint8_t data, const bool RS)
     {
-        // Active low
-        SS_Pin::low();
+        setRS(RS);
         
-        _delay_us(20); // Enable pulse is 20 us
-        
-        SS_Pin::high();
+        // Send upper nibble first, then lower nibble
+        write4Bit(data >> 4);
+        write4Bit(data);
     }
-    
+
     /**
-    @brief Send byte to LCD
-    @param data Byte to be sent to LCD
-    @param RS flag indicating if RS pin should be driven high
+    @brief Switch the backlight on or off
+    @param on Flag indicating if the backlight should be switched on
     */
-    static void write4Bit(const uint8_t data, const bool rs = false)
+    static void setBacklight(const bool on)
     {
-        // Send data bits and RS bit
-        const union
+        if (on)
         {
-            struct
-            {
-                uint8_t dummy:2;
-                bool RS:1;
-                bool backlight:1; // TODO Entfernen, erfordert HW nderung wegen RS Pin!
-                uint8_t DB:4;
-            } data;
-
-            uint8_t byte;
+            s_state |= _BV(t_backlightBit);
         }
-        buffer =
+        else
         {
-            {
-                0, // data.dummy 
-                rs, // data.RS
-                false, // data.backlight 
-                data // data.DB 
-            } // {union}.data
-        };
-        
-        SPIMaster::put(buffer.byte);
-        
-        // Send enable. This also clocks the serial data to the parallel output of the 74HC595 shift register
-        writeEnable();
+            s_state &= ~_BV(t_backlightBit);
+        }
+        shift(s_state);
     }
 
-    /**
-    @brief Send byte to LCD
-    @param data Byte to be sent to LCD
-    @param RS flag indicating if RS pin should be driven high
-    @param backlight Optional flag indicating if LCD backlight should be switched on (if connected)
-    */
-    static void write8Bit(const uint8_t data, const bool RS)
+    private:
+
+    // Transfer one byte to the 74HC595 and latch it to the outputs
+    static void shift(const uint8_t value) __attribute__((always_inline))
     {
-        // Send upper nibble first, then lower nibble. Forward RS bit
-        write4Bit(data >> 4, RS);
-        write4Bit(data, RS);
+        SS_Pin::low();
+        SPIMaster::put(value);
+        SS_Pin::high();
     }
+
+    // Set RS with EN low, so address setup time is met before the next enable pulse
+    static void setRS(const bool RS)
+    {
+        if (RS != static_cast<bool>(s_state & _BV(t_RSBit)))
+        {
+            s_state ^= _BV(t_RSBit);
+            shift(s_state);
+        }
+    }
+
+    // Send lower nibble of data. Data is set up together with the rising edge of EN and latched by the LCD on the falling edge
+    static void write4Bit(const uint8_t data)
+    {
+        const uint8_t value = s_state | ((data & 0x0F) << t_DBShift);
+        shift(value | _BV(t_ENBit));
+        shift(value);
+    }
+
+    // Shadow of RS and backlight outputs. EN and data outputs are always zero
+    static uint8_t s_state;
 };
 
+// Static initialization
+template <typename SPIMaster, typename SS_Pin, uint8_t t_ENBit, uint8_t t_RSBit, uint8_t t_backlightBit, uint8_t t_DBShift>
+uint8_t HD44780_74HC595_Port<SPIMaster, SS_Pin, t_ENBit, t_RSBit, t_backlightBit, t_DBShift>::s_state = 0;
+
+/**
+@brief Low-level driver for configuration of an HD44780 LCD controller in 4 bit mode connected to a 74HC595 8bit serial --> parallel shift register
+Output assignment of the former board layout: RS on Q2, backlight on Q3, data pins D4:7 on Q4:7. EN is driven by the previously unused output Q0 instead of SS_Pin
+@tparam SPIMaster Any SPI master driver implementing a static put() method
+@tparam SS_Pin Any output pin driver implementing stating low() and high() methods, connected to the storage register clock (RCLK) of the 74HC595
+*/
+template <typename SPIMaster, typename SS_Pin>
+using HD44780_Configuration_74HC595 = HD44780_74HC595_Port<SPIMaster, SS_Pin, 0, 2, 3, 4>;
+
 /**
 @brief High-level driver for HD44780 LCD controller in 4 bit mode
 @tparam t_nofCharacter Number of characters on display
@@ -351,6 +682,9 @@ class HD44780 : Port, HD44780_Configuration<t_nofCharacters>
         // Init physical port
         Port::init();
         
+        // Configure all controllers at once
+        selectControllers(ALL_CONTROLLERS);
+        
         // 4 bit / 5x7 pixel / given number of rows
         constexpr uint8_t ui2Line = HD44780_Configuration<t_nofCharacters>::getNofRowsControlWord();
         writeCommand(0x20 | ui2Line);
@@ -370,9 +704,10 @@ class HD44780 : Port, HD44780_Configuration<t_nofCharacters>
     */
     static void clear()
     {
-        // clear command is 0x01, delay is 2 ms
+        // clear command is 0x01, execution time is handled by the port
+        selectControllers(ALL_CONTROLLERS);
         writeCommand(0x01);
-        _delay_ms(2);
+        selectControllers(getControllerMask(0));
     }
     
     /**
@@ -380,18 +715,21 @@ class HD44780 : Port, HD44780_Configuration<t_nofCharacters>
     */
     static void home()
     {
-        // home command is 0x02, delay is 2 ms
+        // home command is 0x02, execution time is handled by the port
+        selectControllers(ALL_CONTROLLERS);
         writeCommand(0x02);
-        _delay_ms(2);
+        selectControllers(getControllerMask(0));
     }
 
     /**
     @brief Set cursor to given row / column position
     @param rowIdx Row index (0..t_nofRows-1)
     @param columnIdx Column index (0..t_nofColumns-1)
+    @note Row addresses are constexpr, so constant arguments result in a single immediate command
     */
-    static void setCursor(const uint8_t rowIdx, const uint8_t columnIdx)
+    static void setCursor(const uint8_t rowIdx, const uint8_t columnIdx) __attribute__((always_inline))
     {
+        selectControllers(getControllerMask(rowIdx));
         writeCommand(0x80 + getRowAddress(rowIdx) + columnIdx);
     }
 
@@ -404,6 +742,16 @@ class HD44780 : Port, HD44780_Configuration<t_nofCharacters>
         writeData(data);
     }
 
+    /**
+    @brief Switch the backlight on or off
+    @param on Flag indicating if the backlight should be switched on
+    @note Only available if the port supports backlight control, e.g. HD44780_74HC595_Port
+    */
+    static void setBacklight(const bool on)
+    {
+        Port::setBacklight(on);
+    }
+
     /**
     @brief Put zero-terminated string (stored in RAM) to LCD
     @param data Zero-terminated string to be sent to LCD
@@ -434,10 +782,13 @@ class HD44780 : Port, HD44780_Configuration<t_nofCharacters>
     @brief Write user character data (stored in RAM) to CG RAM
     @param code Character code
     @param data User character data
-    @note data consists of 8 bytes
+    @note data consists of 8 bytes. Afterwards, setCursor() has to be called before writing characters
     */
     static void generateChar(const uint8_t code, const uint8_t * data)
     {
+        // Each controller has its own CG RAM
+        selectControllers(ALL_CONTROLLERS);
+        
         // Index of character
         writeCommand(0x40 | (code<<3));
         
@@ -453,10 +804,13 @@ class HD44780 : Port, HD44780_Configuration<t_nofCharacters>
     @brief Write user character data (stored in PROGMEM) to CG RAM
     @param code Character code
     @param data User character data
-    @note data consists of 8 bytes
+    @note data consists of 8 bytes. Afterwards, setCursor() has to be called before writing characters
     */
     static void generateChar_P(const uint8_t code, const uint8_t * data)
     {
+        // Each controller has its own CG RAM
+        selectControllers(ALL_CONTROLLERS);
+        
         // Index of character
         writeCommand(0x40 | (code<<3));
         
@@ -467,12 +821,56 @@ class HD44780 : Port, HD44780_Configuration<t_nofCharacters>
             data++;
         }
     }
+
+    /**
+    @brief Write a set of user characters (stored in PROGMEM) to CG RAM
+    CG RAM address is incremented automatically, so all characters are transferred by one address command followed by sequential data writes
+    @param data User character data of consecutive character codes, starting at code 0
+    @param nofCodes Number of characters (1..8)
+    @note data consists of 8 bytes per character. Afterwards, setCursor() has to be called before writing characters
+    */
+    static void loadCharSet_P(const uint8_t * data, const uint8_t nofCodes = 8)
+    {
+        setCGRAMAddress(0);
+        
+        // Transfer bit patterns
+        for (uint8_t cnt = nofCodes * 8; cnt > 0; --cnt)
+        {
+            writeData(pgm_read_byte(data));
+            data++;
+        }
+    }
+
+    /**
+    @brief Set CG RAM address for subsequent data writes via putc()
+    @param address CG RAM address, i.e. (character code << 3) | pixel row (0..63)
+    @note Afterwards, setCursor() has to be called before writing characters
+    */
+    static void setCGRAMAddress(const uint8_t address)
+    {
+        // Each controller has its own CG RAM
+        selectControllers(ALL_CONTROLLERS);
+        
+        writeCommand(0x40 | (address & 0x3F));
+    }
     
     private:
     
     using Port::writeCommand;
     using Port::writeData;
     using HD44780_Configuration<t_nofCharacters>::getRowAddress;
+    using HD44780_Configuration<t_nofCharacters>::getControllerMask;
+    
+    static constexpr uint8_t ALL_CONTROLLERS = 0b11;
+    
+    // Select controllers for subsequent transfers. Only needed for displays with two controllers
+    static void selectControllers(const uint8_t controllerMask) __attribute__((always_inline))
+    {
+        if constexpr (HD44780_Configuration<t_nofCharacters>::getNofControllers() > 1)
+        {
+            Port::selectControllers(controllerMask);
+        }
+    }
 };
 
 #endif
\ No newline at end of file
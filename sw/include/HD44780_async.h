@@ -0,0 +1,306 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HD44780_ASYNC_H
+#define HD44780_ASYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/pgmspace.h>
+#include "HD44780.h"
+#include "ring_buffer.h"
+
+/**
+@brief Non-blocking high-level driver for HD44780 LCD controller in 4 bit mode
+All operations are queued and transferred by tick(), which has to be called periodically, e.g. from a timer ISR.
+Each call transfers at most one byte and the execution time of each command is counted in ticks, so the CPU never waits for the display.
+The initialization sequence including the power-on delay is queued as well, so init() returns immediately.
+@tparam t_nofCharacter Number of characters on display
+@tparam Port Physical port where the LCD is connected to (e.g Parallel GP I/O or 74HC595 shift register)
+@tparam t_tickPeriod_us Period of tick() calls in us
+@tparam t_capacity Number of queued transfers (power of two, 16..128). The initialization sequence takes 10 entries
+@note The busy flag is not polled, even if the R/W pin of a parallel port is connected
+*/
+template <HD44780_NofCharacters t_nofCharacters, typename Port, uint16_t t_tickPeriod_us, uint8_t t_capacity = 64>
+class HD44780_Async : Port, HD44780_Configuration<t_nofCharacters>
+{
+    static_assert(t_tickPeriod_us > 0, "Tick period must not be zero");
+    static_assert(t_capacity >= 16, "Queue capacity must be at least 16 to hold the initialization sequence");
+    static_assert(HD44780_Configuration<t_nofCharacters>::getNofControllers() == 1, "Displays with two controllers are not supported");
+
+    public:
+
+    using HD44780_Configuration<t_nofCharacters>::getNofRows;
+    using HD44780_Configuration<t_nofCharacters>::getNofColumns;
+
+    /**
+    @brief Initialization
+    Initializes the port pins and queues the initialization sequence of the LCD controller
+    @note The queue must be empty, i.e. init() has to be called first
+    */
+    static void init()
+    {
+        // Init physical port pins only
+        Port::initPins();
+
+        // Wait 15 ms until LCD is ready
+        push(0, POWER_ON);
+
+        // Send soft reset three times
+        push(0x30, NIBBLE);
+        push(0x30, NIBBLE);
+        push(0x30, NIBBLE);
+
+        // Enable 4-bit mode
+        push(0x20, NIBBLE);
+
+        // 4 bit / 5x7 pixel / given number of rows
+        constexpr uint8_t ui2Line = HD44780_Configuration<t_nofCharacters>::getNofRowsControlWord();
+        push(0x20 | ui2Line, COMMAND);
+
+        // Display on / Cursor off / Blink off
+        push(0x08 | 0x04, COMMAND);
+
+        // Cursor increment / no scrolling
+        push(0x04 | 0x02, COMMAND);
+
+        clear();
+        home();
+    }
+
+    /**
+    @brief Timer tick
+    This method has to be called every t_tickPeriod_us, e.g. from a timer ISR. Execution time is bounded by one byte transfer
+    */
+    static void tick()
+    {
+        // Wait for execution of the previous transfer
+        if (s_wait > 0 && --s_wait > 0)
+        {
+            return;
+        }
+
+        if (s_queue.empty())
+        {
+            return;
+        }
+
+        const Entry entry = s_queue.front();
+        s_queue.pop();
+
+        switch (entry.type)
+        {
+            case POWER_ON:
+            s_wait = toTicks(15000);
+            break;
+
+            case NIBBLE:
+            Port::writeNibble(entry.value);
+            s_wait = toTicks(5000);
+            break;
+
+            case COMMAND:
+            Port::writeByte(entry.value, false);
+            s_wait = toTicks((entry.value < 0x04) ? HD44780_EXECUTION_TIME_LONG_US : HD44780_EXECUTION_TIME_US);
+            break;
+
+            default:
+            Port::writeByte(entry.value, true);
+            s_wait = toTicks(HD44780_EXECUTION_TIME_US);
+            break;
+        }
+    }
+
+    /**
+    @brief Check if all queued transfers have been sent
+    @result true if the queue is empty
+    @note The execution of the last transfer may still be in progress
+    */
+    static bool isIdle()
+    {
+        return s_queue.empty();
+    }
+
+    /**
+    @brief Get the number of free queue entries
+    @result Number of transfers which can be queued, e.g. characters
+    */
+    static uint8_t available()
+    {
+        return s_queue.available();
+    }
+
+    /**
+    @brief Clear the LCD
+    @result false if the queue is full
+    */
+    static bool clear()
+    {
+        // clear command is 0x01
+        return push(0x01, COMMAND);
+    }
+
+    /**
+    @brief Set cursor to home
+    @result false if the queue is full
+    */
+    static bool home()
+    {
+        // home command is 0x02
+        return push(0x02, COMMAND);
+    }
+
+    /**
+    @brief Set cursor to given row / column position
+    @param rowIdx Row index (0..t_nofRows-1)
+    @param columnIdx Column index (0..t_nofColumns-1)
+    @result false if the queue is full
+    */
+    static bool setCursor(const uint8_t rowIdx, const uint8_t columnIdx)
+    {
+        return push(0x80 + getRowAddress(rowIdx) + columnIdx, COMMAND);
+    }
+
+    /**
+    @brief Put single character to LCD
+    @param data Character to be sent to LCD
+    @result false if the queue is full
+    */
+    static bool putc(const char data)
+    {
+        return push(data, DATA);
+    }
+
+    /**
+    @brief Put zero-terminated string (stored in RAM) to LCD
+    @param data Zero-terminated string to be sent to LCD
+    @result false if the queue is too small. In this case, nothing will be sent
+    */
+    static bool puts(const char *data)
+    {
+        uint8_t length = 0;
+        while (data[length] != '\0')
+        {
+            if (length == s_queue.available())
+            {
+                return false;
+            }
+            ++length;
+        }
+
+        for (; length > 0; --length)
+        {
+            push(*data++, DATA);
+        }
+
+        return true;
+    }
+
+    /**
+    @brief Put zero-terminated string (stored in PROGMEM) to LCD
+    @param data Zero-terminated string to be sent to LCD
+    @result false if the queue is too small. In this case, nothing will be sent
+    */
+    static bool putsP(const char *data)
+    {
+        uint8_t length = 0;
+        while (pgm_read_byte(data + length) != '\0')
+        {
+            if (length == s_queue.available())
+            {
+                return false;
+            }
+            ++length;
+        }
+
+        for (; length > 0; --length)
+        {
+            push(pgm_read_byte(data++), DATA);
+        }
+
+        return true;
+    }
+
+    /**
+    @brief Write user character data (stored in RAM) to CG RAM
+    @param code Character code
+    @param data User character data
+    @result false if the queue is too small. In this case, nothing will be sent
+    @note data consists of 8 bytes
+    */
+    static bool generateChar(const uint8_t code, const uint8_t * data)
+    {
+        if (s_queue.available() < 9)
+        {
+            return false;
+        }
+
+        // Index of character
+        push(0x40 | (code<<3), COMMAND);
+
+        // Transfer bit pattern
+        for (uint8_t cnt = 0; cnt < 8; ++cnt)
+        {
+            push(*data++, DATA);
+        }
+
+        return true;
+    }
+
+    private:
+
+    using HD44780_Configuration<t_nofCharacters>::getRowAddress;
+
+    // Transfer types
+    enum : uint8_t
+    {
+        DATA,
+        COMMAND,
+        NIBBLE,
+        POWER_ON
+    };
+
+    // Queued transfer
+    struct Entry
+    {
+        uint8_t value;
+        uint8_t type;
+    };
+
+    static constexpr uint16_t toTicks(const uint32_t time_us)
+    {
+        return (time_us + t_tickPeriod_us - 1) / t_tickPeriod_us;
+    }
+
+    static bool push(const uint8_t value, const uint8_t type)
+    {
+        return s_queue.push(Entry{value, type});
+    }
+
+    static RingBuffer<Entry, t_capacity> s_queue;
+    static uint16_t s_wait; // Remaining ticks until the next transfer
+};
+
+// Static initialization
+template <HD44780_NofCharacters t_nofCharacters, typename Port, uint16_t t_tickPeriod_us, uint8_t t_capacity>
+RingBuffer<typename HD44780_Async<t_nofCharacters, Port, t_tickPeriod_us, t_capacity>::Entry, t_capacity> HD44780_Async<t_nofCharacters, Port, t_tickPeriod_us, t_capacity>::s_queue;
+
+// Static initialization
+template <HD44780_NofCharacters t_nofCharacters, typename Port, uint16_t t_tickPeriod_us, uint8_t t_capacity>
+uint16_t HD44780_Async<t_nofCharacters, Port, t_tickPeriod_us, t_capacity>::s_wait = 0;
+
+#endif
@@ -0,0 +1,227 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HD44780_FRAMEBUFFER_H
+#define HD44780_FRAMEBUFFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/pgmspace.h>
+
+/**
+@brief Framebuffer for HD44780 LCD controller
+The application writes to a RAM framebuffer without any LCD access. refresh() compares the framebuffer with a copy of the current display content
+and only transfers changed characters. A cursor command is only sent if the next changed character does not directly follow the previous one.
+@tparam Display HD44780 driver class, i.e. a specialization of HD44780
+@note The display must not be written directly while the framebuffer is in use, otherwise invalidate() has to be called
+*/
+template <typename Display>
+class HD44780_Framebuffer
+{
+    public:
+
+    /**
+    @brief Get number of display rows
+    @result Number of display rows
+    */
+    static constexpr uint8_t getNofRows()
+    {
+        return Display::getNofRows();
+    }
+
+    /**
+    @brief Get number of display columns
+    @result Number of display columns
+    */
+    static constexpr uint8_t getNofColumns()
+    {
+        return Display::getNofColumns();
+    }
+
+    /**
+    @brief Initialization
+    Initializes the display, which is cleared afterwards
+    */
+    static void init()
+    {
+        Display::init();
+        fill(s_display, ' ');
+        clear();
+    }
+
+    /**
+    @brief Clear the framebuffer and set cursor to home
+    */
+    static void clear()
+    {
+        fill(s_frame, ' ');
+        setCursor(0, 0);
+    }
+
+    /**
+    @brief Set framebuffer cursor to given row / column position
+    @param rowIdx Row index (0..getNofRows()-1)
+    @param columnIdx Column index (0..getNofColumns()-1)
+    */
+    static void setCursor(const uint8_t rowIdx, const uint8_t columnIdx)
+    {
+        s_rowIdx = rowIdx;
+        s_columnIdx = columnIdx;
+    }
+
+    /**
+    @brief Put single character to framebuffer
+    @param data Character to be written at the cursor position
+    @note Characters exceeding the end of the row are discarded
+    */
+    static void putc(const char data)
+    {
+        if (s_rowIdx < getNofRows() && s_columnIdx < getNofColumns())
+        {
+            s_frame[s_rowIdx][s_columnIdx] = data;
+            ++s_columnIdx;
+        }
+    }
+
+    /**
+    @brief Put zero-terminated string (stored in RAM) to framebuffer
+    @param data Zero-terminated string to be written at the cursor position
+    */
+    static void puts(const char *data)
+    {
+        while (*data != '\0')
+        {
+            putc(*data++);
+        }
+    }
+
+    /**
+    @brief Put zero-terminated string (stored in PROGMEM) to framebuffer
+    @param data Zero-terminated string to be written at the cursor position
+    */
+    static void putsP(const char *data)
+    {
+        char character = pgm_read_byte(data++);
+        while (character != '\0')
+        {
+            putc(character);
+            character = pgm_read_byte(data++);
+        }
+    }
+
+    /**
+    @brief Get a character from the framebuffer
+    @param rowIdx Row index (0..getNofRows()-1)
+    @param columnIdx Column index (0..getNofColumns()-1)
+    @result Character at given position
+    */
+    static char getc(const uint8_t rowIdx, const uint8_t columnIdx)
+    {
+        return s_frame[rowIdx][columnIdx];
+    }
+
+    /**
+    @brief Transfer all changed characters to the display
+    @result Number of characters transferred
+    */
+    static uint8_t refresh()
+    {
+        uint8_t nofTransfers = 0;
+
+        for (uint8_t rowIdx = 0; rowIdx < getNofRows(); ++rowIdx)
+        {
+            // Position of the display cursor, invalid at the beginning of each row
+            uint8_t cursorIdx = getNofColumns();
+
+            for (uint8_t columnIdx = 0; columnIdx < getNofColumns(); ++columnIdx)
+            {
+                const char data = s_frame[rowIdx][columnIdx];
+                if (data == s_display[rowIdx][columnIdx])
+                {
+                    continue;
+                }
+
+                // Display cursor is incremented automatically, so contiguous characters don't need a cursor command
+                if (cursorIdx != columnIdx)
+                {
+                    Display::setCursor(rowIdx, columnIdx);
+                }
+
+                Display::putc(data);
+                s_display[rowIdx][columnIdx] = data;
+                cursorIdx = columnIdx + 1;
+                ++nofTransfers;
+            }
+        }
+
+        return nofTransfers;
+    }
+
+    /**
+    @brief Force a complete transfer of the framebuffer on the next refresh()
+    @note This is needed if the display has been written directly, e.g. after HD44780::clear()
+    */
+    static void invalidate()
+    {
+        // No character is equal to all characters, so the display copy is toggled against the framebuffer
+        for (uint8_t rowIdx = 0; rowIdx < getNofRows(); ++rowIdx)
+        {
+            for (uint8_t columnIdx = 0; columnIdx < getNofColumns(); ++columnIdx)
+            {
+                s_display[rowIdx][columnIdx] = ~s_frame[rowIdx][columnIdx];
+            }
+        }
+    }
+
+    private:
+
+    typedef char Buffer[Display::getNofRows()][Display::getNofColumns()];
+
+    static void fill(Buffer & buffer, const char data)
+    {
+        for (uint8_t rowIdx = 0; rowIdx < getNofRows(); ++rowIdx)
+        {
+            for (uint8_t columnIdx = 0; columnIdx < getNofColumns(); ++columnIdx)
+            {
+                buffer[rowIdx][columnIdx] = data;
+            }
+        }
+    }
+
+    static Buffer s_frame; // Content written by the application
+    static Buffer s_display; // Content shown on the display
+    static uint8_t s_rowIdx;
+    static uint8_t s_columnIdx;
+};
+
+// Static initialization
+template <typename Display>
+typename HD44780_Framebuffer<Display>::Buffer HD44780_Framebuffer<Display>::s_frame;
+
+// Static initialization
+template <typename Display>
+typename HD44780_Framebuffer<Display>::Buffer HD44780_Framebuffer<Display>::s_display;
+
+// Static initialization
+template <typename Display>
+uint8_t HD44780_Framebuffer<Display>::s_rowIdx = 0;
+
+// Static initialization
+template <typename Display>
+uint8_t HD44780_Framebuffer<Display>::s_columnIdx = 0;
+
+#endif
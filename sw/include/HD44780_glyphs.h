@@ -0,0 +1,180 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HD44780_GLYPHS_H
+#define HD44780_GLYPHS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/pgmspace.h>
+
+/**
+@brief Animation of user characters (glyphs) of HD44780 LCD controller, e.g. for bar graphs or spinners
+The application updates the glyphs in RAM. update() compares them with a copy of the CG RAM content and only transfers changed pixel rows.
+An address command is only sent if the next changed row does not directly follow the previous one.
+@tparam Display HD44780 driver class, i.e. a specialization of HD44780
+@note After update() has transferred data, the display cursor has to be set again before writing characters (HD44780_Framebuffer::refresh() does this implicitly)
+*/
+template <typename Display>
+class HD44780_GlyphAnimation
+{
+    public:
+
+    /**
+    @brief Get number of user characters
+    @result Number of user characters
+    */
+    static constexpr uint8_t getNofCodes()
+    {
+        return 8;
+    }
+
+    /**
+    @brief Initialization
+    As the CG RAM content is undefined after power-on, all glyphs will be transferred on the next update()
+    */
+    static void init()
+    {
+        invalidate();
+    }
+
+    /**
+    @brief Set a glyph (stored in RAM)
+    @param code Character code (0..7)
+    @param data Pixel rows of the glyph (8 bytes)
+    */
+    static void setGlyph(const uint8_t code, const uint8_t * data)
+    {
+        for (uint8_t row = 0; row < 8; ++row)
+        {
+            setRow(code, row, *data++);
+        }
+    }
+
+    /**
+    @brief Set a glyph (stored in PROGMEM)
+    @param code Character code (0..7)
+    @param data Pixel rows of the glyph (8 bytes)
+    */
+    static void setGlyph_P(const uint8_t code, const uint8_t * data)
+    {
+        for (uint8_t row = 0; row < 8; ++row)
+        {
+            setRow(code, row, pgm_read_byte(data++));
+        }
+    }
+
+    /**
+    @brief Set one pixel row of a glyph
+    @param code Character code (0..7)
+    @param row Pixel row (0..7)
+    @param pixels Pixels of the row (bits 4:0)
+    */
+    static void setRow(const uint8_t code, const uint8_t row, const uint8_t pixels)
+    {
+        uint8_t & glyphRow = s_glyphs[getAddress(code, row)];
+        if (glyphRow != pixels)
+        {
+            glyphRow = pixels;
+            s_modified |= _BV(code);
+        }
+    }
+
+    /**
+    @brief Transfer all changed pixel rows to CG RAM
+    @result Number of pixel rows transferred
+    */
+    static uint8_t update()
+    {
+        uint8_t nofTransfers = 0;
+
+        // CG RAM address counter of the display, invalid at the beginning
+        uint8_t cursor = 0xFF;
+
+        for (uint8_t code = 0; code < getNofCodes(); ++code)
+        {
+            if (!(s_modified & _BV(code)))
+            {
+                continue;
+            }
+
+            for (uint8_t address = getAddress(code, 0); address < getAddress(code + 1, 0); ++address)
+            {
+                const uint8_t pixels = s_glyphs[address];
+                if (pixels == s_loaded[address])
+                {
+                    continue;
+                }
+
+                // CG RAM address is incremented automatically, so contiguous rows don't need an address command
+                if (cursor != address)
+                {
+                    Display::setCGRAMAddress(address);
+                }
+
+                Display::putc(pixels);
+                s_loaded[address] = pixels;
+                cursor = address + 1;
+                ++nofTransfers;
+            }
+        }
+
+        s_modified = 0;
+
+        return nofTransfers;
+    }
+
+    /**
+    @brief Force a complete transfer of all glyphs on the next update()
+    @note This is needed if the CG RAM has been written directly, e.g. by HD44780::generateChar()
+    */
+    static void invalidate()
+    {
+        // Toggle the CG RAM copy against the glyphs, so every row differs
+        for (uint8_t address = 0; address < getNofCodes() * 8; ++address)
+        {
+            s_loaded[address] = ~s_glyphs[address];
+        }
+
+        s_modified = 0xFF;
+    }
+
+    private:
+
+    static constexpr uint8_t getAddress(const uint8_t code, const uint8_t row)
+    {
+        return (code << 3) | row;
+    }
+
+    static uint8_t s_glyphs[8 * 8]; // Glyphs set by the application
+    static uint8_t s_loaded[8 * 8]; // Glyphs stored in CG RAM
+    static uint8_t s_modified; // Bit mask of glyphs modified since the last update
+};
+
+// Static initialization
+template <typename Display>
+uint8_t HD44780_GlyphAnimation<Display>::s_glyphs[8 * 8];
+
+// Static initialization
+template <typename Display>
+uint8_t HD44780_GlyphAnimation<Display>::s_loaded[8 * 8];
+
+// Static initialization
+template <typename Display>
+uint8_t HD44780_GlyphAnimation<Display>::s_modified = 0;
+
+#endif
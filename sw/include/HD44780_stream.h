@@ -0,0 +1,226 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HD44780_STREAM_H
+#define HD44780_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/pgmspace.h>
+
+/**
+@brief Formatted output of integer and fixed-point numbers for HD44780 LCD controller
+Characters are written directly to the output, so no temporary buffer and no sprintf() is needed.
+Decimal digits are determined by subtracting powers of ten, which is much faster than a generic division on AVR.
+The number of digits is limited at compile time by the data type, so 8 and 16 bit values are formatted using 8 and 16 bit arithmetic only.
+@tparam Output Any class implementing a static putc(char) method, e.g. HD44780, HD44780_Framebuffer or HD44780_Async
+*/
+template <typename Output>
+class HD44780_Stream
+{
+    public:
+
+    /**
+    @brief Put unsigned 8 bit value in decimal format
+    @param value Value to be written
+    @param width Minimum number of characters. Shorter numbers are padded on the left side
+    @param pad Padding character, e.g. ' ' or '0'
+    */
+    static void putu8(const uint8_t value, const uint8_t width = 0, const char pad = ' ')
+    {
+        putDecimal(value, false, width, pad, 0);
+    }
+
+    /**
+    @brief Put unsigned 16 bit value in decimal format
+    @param value Value to be written
+    @param width Minimum number of characters. Shorter numbers are padded on the left side
+    @param pad Padding character, e.g. ' ' or '0'
+    */
+    static void putu16(const uint16_t value, const uint8_t width = 0, const char pad = ' ')
+    {
+        putDecimal(value, false, width, pad, 0);
+    }
+
+    /**
+    @brief Put unsigned 32 bit value in decimal format
+    @param value Value to be written
+    @param width Minimum number of characters. Shorter numbers are padded on the left side
+    @param pad Padding character, e.g. ' ' or '0'
+    */
+    static void putu32(const uint32_t value, const uint8_t width = 0, const char pad = ' ')
+    {
+        putDecimal(value, false, width, pad, 0);
+    }
+
+    /**
+    @brief Put signed 8 bit value in decimal format
+    @param value Value to be written
+    @param width Minimum number of characters including sign. Shorter numbers are padded on the left side
+    @param pad Padding character, e.g. ' ' or '0'. Zero padding is inserted behind the sign
+    */
+    static void puti8(const int8_t value, const uint8_t width = 0, const char pad = ' ')
+    {
+        putDecimal(getMagnitude<uint8_t>(value), value < 0, width, pad, 0);
+    }
+
+    /**
+    @brief Put signed 16 bit value in decimal format
+    @param value Value to be written
+    @param width Minimum number of characters including sign. Shorter numbers are padded on the left side
+    @param pad Padding character, e.g. ' ' or '0'. Zero padding is inserted behind the sign
+    */
+    static void puti16(const int16_t value, const uint8_t width = 0, const char pad = ' ')
+    {
+        putDecimal(getMagnitude<uint16_t>(value), value < 0, width, pad, 0);
+    }
+
+    /**
+    @brief Put signed 32 bit value in decimal format
+    @param value Value to be written
+    @param width Minimum number of characters including sign. Shorter numbers are padded on the left side
+    @param pad Padding character, e.g. ' ' or '0'. Zero padding is inserted behind the sign
+    */
+    static void puti32(const int32_t value, const uint8_t width = 0, const char pad = ' ')
+    {
+        putDecimal(getMagnitude<uint32_t>(value), value < 0, width, pad, 0);
+    }
+
+    /**
+    @brief Put signed 16 bit fixed-point value in decimal format
+    @param value Value to be written, scaled by 10^nofFractionalDigits. E.g. 235 with one fractional digit is written as "23.5"
+    @param nofFractionalDigits Number of digits behind the decimal point (0..4)
+    @param width Minimum number of characters including sign and decimal point. Shorter numbers are padded on the left side
+    @param pad Padding character, e.g. ' ' or '0'. Zero padding is inserted behind the sign
+    */
+    static void putFixed(const int16_t value, const uint8_t nofFractionalDigits, const uint8_t width = 0, const char pad = ' ')
+    {
+        putDecimal(getMagnitude<uint16_t>(value), value < 0, width, pad, nofFractionalDigits);
+    }
+
+    /**
+    @brief Put signed 32 bit fixed-point value in decimal format
+    @param value Value to be written, scaled by 10^nofFractionalDigits. E.g. 235 with one fractional digit is written as "23.5"
+    @param nofFractionalDigits Number of digits behind the decimal point (0..9)
+    @param width Minimum number of characters including sign and decimal point. Shorter numbers are padded on the left side
+    @param pad Padding character, e.g. ' ' or '0'. Zero padding is inserted behind the sign
+    */
+    static void putFixed(const int32_t value, const uint8_t nofFractionalDigits, const uint8_t width = 0, const char pad = ' ')
+    {
+        putDecimal(getMagnitude<uint32_t>(value), value < 0, width, pad, nofFractionalDigits);
+    }
+
+    /**
+    @brief Put 8 bit value in hexadecimal format (2 digits, upper case)
+    @param value Value to be written
+    */
+    static void putx8(const uint8_t value)
+    {
+        putHexDigit(value >> 4);
+        putHexDigit(value);
+    }
+
+    /**
+    @brief Put 16 bit value in hexadecimal format (4 digits, upper case)
+    @param value Value to be written
+    */
+    static void putx16(const uint16_t value)
+    {
+        putx8(value >> 8);
+        putx8(value);
+    }
+
+    private:
+
+    // Maximum number of decimal digits of given unsigned data type
+    template <typename T>
+    static constexpr uint8_t getMaxDigits()
+    {
+        return (sizeof(T) == 1) ? 3 : ((sizeof(T) == 2) ? 5 : 10);
+    }
+
+    // Get 10^exponent (exponent 0..9)
+    static uint32_t getPower(const uint8_t exponent)
+    {
+        static const uint32_t power[10] PROGMEM = {1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL, 100000000UL, 1000000000UL};
+        return pgm_read_dword(&power[exponent]);
+    }
+
+    // Absolute value of signed value as unsigned data type. This also works for the most negative value
+    template <typename T, typename S>
+    static constexpr T getMagnitude(const S value)
+    {
+        return (value < 0) ? static_cast<T>(-static_cast<T>(value)) : static_cast<T>(value);
+    }
+
+    // Put decimal number. If nofFractionalDigits > 0, a decimal point is inserted and leading zeros are written up to the digit in front of it
+    template <typename T>
+    static void putDecimal(T value, const bool negative, const uint8_t width, const char pad, const uint8_t nofFractionalDigits)
+    {
+        // Count digits before writing anything, so padding can be written first
+        uint8_t nofDigits = nofFractionalDigits + 1;
+        while (nofDigits < getMaxDigits<T>() && value >= static_cast<T>(getPower(nofDigits)))
+        {
+            ++nofDigits;
+        }
+
+        uint8_t length = nofDigits + (negative ? 1 : 0) + ((nofFractionalDigits > 0) ? 1 : 0);
+
+        // Zero padding follows the sign, other padding precedes it
+        if (negative && pad == '0')
+        {
+            Output::putc('-');
+        }
+
+        for (; length < width; ++length)
+        {
+            Output::putc(pad);
+        }
+
+        if (negative && pad != '0')
+        {
+            Output::putc('-');
+        }
+
+        for (uint8_t exponent = nofDigits; exponent > 0; --exponent)
+        {
+            if (exponent == nofFractionalDigits)
+            {
+                Output::putc('.');
+            }
+
+            // Digit is determined by repeated subtraction. Each loop is executed at most nine times
+            const T power = getPower(exponent - 1);
+            char digit = '0';
+            while (value >= power)
+            {
+                value -= power;
+                ++digit;
+            }
+
+            Output::putc(digit);
+        }
+    }
+
+    static void putHexDigit(uint8_t value)
+    {
+        value &= 0x0F;
+        Output::putc((value < 10) ? ('0' + value) : ('A' - 10 + value));
+    }
+};
+
+#endif
@@ -0,0 +1,82 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MCP23008_H
+#define MCP23008_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "MCP23XXX.h"
+#include "MCP23xxx_transport.h"
+
+#define MCP23008_MAX_I2C_CLOCK 1700000UL // 1.7 MHz
+
+/**
+@brief MCP23008/MCP23S08 pin index GP0..7
+*/
+enum class MCP23x08PinIdx
+{
+    GP0 = 0,
+    GP1 = 1,
+    GP2 = 2,
+    GP3 = 3,
+    GP4 = 4,
+    GP5 = 5,
+    GP6 = 6,
+    GP7 = 7
+};
+
+/**
+@brief MCP23008/MCP23S08 Pin Configuration
+Each used GP I/O pin of a MCP23008 or MCP23S08 device has to be assigned a Pin Type
+@tparam t_pinIdx Index GP0..7 of a used GP I/O pin
+@tparam t_pinType Pin type assigned to pin index
+@tparam t_CallbackPolicy Callback policy for pin types with callbacks, i.e. MCP23xxxDynamicCallback (default), MCP23xxxStaticCallback or MCP23xxxDeferredCallback
+*/
+template <MCP23x08PinIdx t_pinIdx, MCP23xxxPinType t_pinType, typename t_CallbackPolicy = MCP23xxxDynamicCallback>
+struct MCP23x08PinConfig
+{
+    static constexpr MCP23x08PinIdx s_pinIdx = t_pinIdx;
+    static constexpr MCP23xxxPinType s_pinType = t_pinType;
+    typedef t_CallbackPolicy CallbackPolicy;
+};
+
+/**
+@brief Driver for I2C port expander MCP23008
+@tparam TWIMaster TWI master driver class implementing static methods start(uint8_t), put(uint8_t), get(bool) and stop(), see MCP23xxxI2CTransport
+@tparam t_hardwareAddress Hardware address A2..A0 (0..7)
+@tparam PinConfig Pack of MCP23x08PinConfig specializations for all used GP I/O pins
+*/
+template <
+DrvTWIMaster TWIMaster,
+uint8_t t_hardwareAddress,
+PinConfiguration ... PinConfig>
+class MCP23008 : public MCP23xxxDevice<MCP23xxxI2CTransport<TWIMaster, t_hardwareAddress>, MCP23xxxPort8, PinConfig ...>
+{
+    public:
+
+    /**
+    @brief Get the maximum I2C clock of the device
+    @result Maximum I2C clock in Hz
+    */
+    static constexpr uint32_t getMaxI2CClock()
+    {
+        return MCP23008_MAX_I2C_CLOCK;
+    }
+};
+
+#endif
@@ -0,0 +1,54 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MCP23017_H
+#define MCP23017_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "MCP23XXX.h"
+#include "MCP23xxx_transport.h"
+#include "MCP23S17.h"
+
+#define MCP23017_MAX_I2C_CLOCK 1700000UL // 1.7 MHz
+
+/**
+@brief Driver for I2C port expander MCP23017
+The MCP23017 has the same register set and pinout as the MCP23S17, so pins are configured using MCP23S17PinIdx and MCP23S17PinConfig. Register pairs, the configuration block and the interrupt registers are accessed by sequential transfers, so e.g. onInterrupt() takes one I2C access instead of four
+@tparam TWIMaster TWI master driver class implementing static methods start(uint8_t), put(uint8_t), get(bool) and stop(), see MCP23xxxI2CTransport
+@tparam t_hardwareAddress Hardware address A2..A0 (0..7)
+@tparam PinConfig Pack of MCP23S17PinConfig specializations for all used GP I/O pins
+*/
+template <
+DrvTWIMaster TWIMaster,
+uint8_t t_hardwareAddress,
+PinConfiguration ... PinConfig>
+class MCP23017 : public MCP23xxxDevice<MCP23xxxI2CTransport<TWIMaster, t_hardwareAddress>, MCP23xxxPort16, PinConfig ...>
+{
+    public:
+
+    /**
+    @brief Get the maximum I2C clock of the device
+    @result Maximum I2C clock in Hz
+    */
+    static constexpr uint32_t getMaxI2CClock()
+    {
+        return MCP23017_MAX_I2C_CLOCK;
+    }
+};
+
+#endif
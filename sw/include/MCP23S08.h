@@ -0,0 +1,71 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MCP23S08_H
+#define MCP23S08_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "MCP23XXX.h"
+#include "MCP23xxx_transport.h"
+#include "MCP23008.h"
+
+#define MCP23S08_MAX_SPI_CLOCK 10000000UL // 10 MHz
+
+/**
+@brief Driver for SPI port expander MCP23S08 with hardware addressing
+Up to 4 devices with different hardware addresses (pins A1..A0) can share one SS pin. Pins are configured using MCP23x08PinIdx and MCP23x08PinConfig
+@tparam SPIMaster SPI master driver class implementing static methods put(uint8_t) and get()
+@tparam SSPin Pin driver class implementing static methods high() and low()
+@tparam t_hardwareAddress Hardware address A1..A0 (0..3) or MCP23XXX_NO_HARDWARE_ADDRESS
+@tparam PinConfig Pack of MCP23x08PinConfig specializations for all used GP I/O pins
+*/
+template <
+DrvSPIMaster SPIMaster,
+DrvGPIOPin SSPin,
+uint8_t t_hardwareAddress,
+PinConfiguration ... PinConfig>
+class MCP23S08Addressed : public MCP23xxxDevice<MCP23xxxSPITransport<SPIMaster, SSPin, t_hardwareAddress>, MCP23xxxPort8, PinConfig ...>
+{
+    static_assert(t_hardwareAddress < 4 || t_hardwareAddress == MCP23XXX_NO_HARDWARE_ADDRESS, "Invalid hardware address");
+
+    public:
+
+    /**
+    @brief Get the maximum SPI clock of the device
+    @result Maximum SPI clock in Hz
+    */
+    static constexpr uint32_t getMaxSPIClock()
+    {
+        return MCP23S08_MAX_SPI_CLOCK;
+    }
+};
+
+/**
+@brief Driver for SPI port expander MCP23S08 without hardware addressing
+@tparam SPIMaster SPI master driver class implementing static methods put(uint8_t) and get()
+@tparam SSPin Pin driver class implementing static methods high() and low()
+@tparam PinConfig Pack of MCP23x08PinConfig specializations for all used GP I/O pins
+*/
+template <
+DrvSPIMaster SPIMaster,
+DrvGPIOPin SSPin,
+PinConfiguration ... PinConfig>
+class MCP23S08 : public MCP23S08Addressed<SPIMaster, SSPin, MCP23XXX_NO_HARDWARE_ADDRESS, PinConfig ...>
+{};
+
+#endif
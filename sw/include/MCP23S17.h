@@ -21,6 +21,7 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 #include <stdint.h>
 #include <stdbool.h>
 #include "MCP23XXX.h"
+#include "MCP23xxx_transport.h"
 
 #define MCP23S17_MAX_SPI_CLOCK 10000000UL // 10 MHz
 
@@ -52,37 +53,48 @@ enum class MCP23S17PinIdx
 Each used GP I/O pin of a MCP23S17 device has to be assigned a Pin Type
 @tparam t_pinIdx Index A0..7 and B0..7 of a used GP I/O pin
 @tparam t_pinType Pin type assigned to pin index
+@tparam t_CallbackPolicy Callback policy for pin types with callbacks, i.e. MCP23xxxDynamicCallback (default), MCP23xxxStaticCallback or MCP23xxxDeferredCallback
 */
-template <MCP23S17PinIdx t_pinIdx, MCP23xxxPinType t_pinType>
+template <MCP23S17PinIdx t_pinIdx, MCP23xxxPinType t_pinType, typename t_CallbackPolicy = MCP23xxxDynamicCallback>
 struct MCP23S17PinConfig
 {
     static constexpr MCP23S17PinIdx s_pinIdx = t_pinIdx;
     static constexpr MCP23xxxPinType s_pinType = t_pinType;
+    typedef t_CallbackPolicy CallbackPolicy;
 };
 
-template <typename T>
-concept DrvSPIMaster = requires(uint8_t a)
-{
-    T::put(a);
-    a = T::get();
-};
+/// @brief Hardware address value for MCP23S17 devices not using hardware addressing (IOCON.HAEN disabled)
+constexpr uint8_t MCP23S17_NO_HARDWARE_ADDRESS = MCP23XXX_NO_HARDWARE_ADDRESS;
 
-template <typename T>
-concept DrvGPIOPin = requires
+/**
+@brief Driver for SPI port expander MCP23S17 with hardware addressing
+Up to 8 devices with different hardware addresses (pins A2..A0) can share one SS pin
+@tparam SPIMaster SPI master driver class implementing static methods put(uint8_t) and get()
+@tparam SSPin Pin driver class implementing static methods high() and low()
+@tparam t_hardwareAddress Hardware address A2..A0 (0..7) or MCP23S17_NO_HARDWARE_ADDRESS
+@tparam PinConfig Pack of MCP23S17PinConfig specializations for all used GP I/O pins
+*/
+template <
+DrvSPIMaster SPIMaster,
+DrvGPIOPin SSPin,
+uint8_t t_hardwareAddress,
+PinConfiguration ... PinConfig>
+class MCP23S17Addressed : public MCP23xxxDevice<MCP23xxxSPITransport<SPIMaster, SSPin, t_hardwareAddress>, MCP23xxxPort16, PinConfig ...>
 {
-     T::high();
-     T::low();
-};
+    public:
 
-template <typename T>
-concept PinConfiguration = requires
-{
-    T::s_pinIdx;
-    T::s_pinType;
+    /**
+    @brief Get the maximum SPI clock of the device
+    @result Maximum SPI clock in Hz
+    */
+    static constexpr uint32_t getMaxSPIClock()
+    {
+        return MCP23S17_MAX_SPI_CLOCK;
+    }
 };
 
 /**
-@brief Driver for SPI port expander MCP23S17
+@brief Driver for SPI port expander MCP23S17 without hardware addressing
 @tparam SPIMaster SPI master driver class implementing static methods put(uint8_t) and get()
 @tparam SSPin Pin driver class implementing static methods high() and low()
 @tparam PinConfig Pack of MCP23S17PinConfig specializations for all used GP I/O pins
@@ -91,504 +103,90 @@ template <
 DrvSPIMaster SPIMaster,
 DrvGPIOPin SSPin,
 PinConfiguration ... PinConfig>
-class MCP23S17 : MCP23xxx
+class MCP23S17 : public MCP23S17Addressed<SPIMaster, SSPin, MCP23S17_NO_HARDWARE_ADDRESS, PinConfig ...>
+{};
+
+template <typename T>
+concept MCP23S17BusDevice = requires
 {
-    private:
-    
-    /**
-    @brief Register-level driver class for MCP23S17 GP I/O pin
-    @tparam t_pinIdx Pin index A0..A7 and B0..B7
-    */
-    template <MCP23S17PinIdx t_pinIdx, bool t_portA = (static_cast<uint8_t>(t_pinIdx) & 0b1000)>
-    class PinRegisterAccess;
+    T::getHardwareAddress();
+    T::hasInterrupts();
+};
 
-    /**
-    @brief Register-level driver class for MCP23S17 GP I/O pin. Specialization for pins on I/O port A
-    @tparam t_pinIdx Pin index A0..A7 and B0..B7
-    */
-    template <MCP23S17PinIdx t_pinIdx>
-    class PinRegisterAccess<t_pinIdx, true>
-    {
-        protected:
-        
-        static bool readINTCAP() __attribute__((always_inline))
-        {
-            return readRegister(INTCAPA) & getBitmask();
-        }
-        
-        static bool readGPIO() __attribute__((always_inline))
-        {
-            return readRegister(GPIOA) & getBitmask();
-        }
-        
-        static void writeOLATA(const bool bValue)
-        {
-            if (bValue)
-            {
-                writeRegister(OLATA, readRegister(OLATA) | getBitmask());
-            }
-            else
-            {
-                writeRegister(OLATA, readRegister(OLATA) & (~getBitmask()));
-            }
-        }
-        
-        private:
-        
-        static constexpr uint8_t getBitmask()
-        {
-            static_assert(static_cast<uint8_t>(t_pinIdx) < 16, "Invalid pin number");
-            return _BV(static_cast<uint8_t>(t_pinIdx) & 0b111);
-        }
-    };
+/**
+@brief Aggregator for up to 8 MCP23S17 devices using hardware addressing on one shared SS pin
+The interrupt outputs of all devices are configured as open-drain outputs, so they can be wired to one shared (active low) interrupt line
+@tparam Device Pack of MCP23S17Addressed specializations sharing SPI master and SS pin
+*/
+template <MCP23S17BusDevice ... Device>
+class MCP23S17Bus
+{
+    static_assert(sizeof...(Device) > 0 && sizeof...(Device) <= 8, "Number of devices must be 1..8");
+    static_assert(((Device::getHardwareAddress() < 8) && ...), "All devices must use hardware addressing");
 
-    /**
-    @brief Register-level driver class for MCP23S17 GP I/O pin. Specialization for pins on I/O port B
-    @tparam t_pinIdx Pin index A0..A7 and B0..B7
-    */
-    template <MCP23S17PinIdx t_pinIdx>
-    class PinRegisterAccess<t_pinIdx, false>
-    {
-        protected:
-        
-        static bool readINTCAP() __attribute__((always_inline))
-        {
-            return readRegister(INTCAPB) & getBitmask();
-        }
-        
-        static bool readGPIO() __attribute__((always_inline))
-        {
-            return readRegister(GPIOB) & getBitmask();
-        }
-        
-        static void writeOLAT(const bool bValue)
-        {
-            if (bValue)
-            {
-                writeRegister(OLATB, readRegister(OLATB) | getBitmask());
-            }
-            else
-            {
-                writeRegister(OLATB, readRegister(OLATB) & (~getBitmask()));
-            }
-        }
-        
-        private:
-        
-        static constexpr uint8_t getBitmask()
-        {
-            static_assert(static_cast<uint8_t>(t_pinIdx) < 16, "Invalid pin number");
-            return _BV(static_cast<uint8_t>(t_pinIdx) & 0b111);
-        }
-    };
-    
-    // Struct retrieving the pin type from the pin configuration for a given pin index
-    template <MCP23S17PinIdx t_pinIdx, typename CurrentPinConfig, typename ... NextPinConfig>
-    struct PinIdxToPinType
-    {
-        // Search the parameter pack for configuration of given pin index
-        static constexpr MCP23xxxPinType value = (t_pinIdx == CurrentPinConfig::s_pinIdx) ? CurrentPinConfig::s_pinType : PinIdxToPinType<t_pinIdx, NextPinConfig ...>::value;
-    };
-    
-    // Struct retrieving the pin type from the pin configuration for a given pin index
-    // Termination for last configured pin
-    template <MCP23S17PinIdx t_pinIdx, typename CurrentPinConfig>
-    struct PinIdxToPinType <t_pinIdx, CurrentPinConfig>
-    {
-        // If a configuration for given pin index does not exist, the pin is considered as unused
-        static constexpr MCP23xxxPinType value = (t_pinIdx == CurrentPinConfig::s_pinIdx) ? CurrentPinConfig::s_pinType : MCP23xxxPinType::UNUSED;
-    };
-    
     public:
 
     /**
-    @brief Pin interface combining pin type and register access for selected pin
-    @tparam t_pinIdx Pin index A0..A7 and B0..B7
+    @brief Get the number of devices
+    @result Number of devices
     */
-    template <MCP23S17PinIdx t_pinIdx>
-    using Pin = MCP23xxx::Pin<PinRegisterAccess<t_pinIdx>, PinIdxToPinType<t_pinIdx, PinConfig ...>::value>;
-
-    /**
-    @brief Initialization
-    */
-    static void init(const bool intActiveHigh = true)
+    static constexpr uint8_t getNofDevices()
     {
-        checkConfig(); // Will evaluate at compile time and assert in case something is wrong with the pin configuration
-
-        // Interrupt output active high --> set INTPOL bit
-        uint8_t valueIOCON = _BV(SEQOP) | _BV(MIRROR) | (intActiveHigh ? _BV(INTPOL) : 0);
-        writeRegister(IOCON, valueIOCON);
-        
-        writeRegisterPair(IODIRA,
-        (Pin<MCP23S17PinIdx::B0>::s_IODIRBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B0)) : 0) +
-        (Pin<MCP23S17PinIdx::B1>::s_IODIRBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B1)) : 0) +
-        (Pin<MCP23S17PinIdx::B2>::s_IODIRBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B2)) : 0) +
-        (Pin<MCP23S17PinIdx::B3>::s_IODIRBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B3)) : 0) +
-        (Pin<MCP23S17PinIdx::B4>::s_IODIRBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B4)) : 0) +
-        (Pin<MCP23S17PinIdx::B5>::s_IODIRBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B5)) : 0) +
-        (Pin<MCP23S17PinIdx::B6>::s_IODIRBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B6)) : 0) +
-        (Pin<MCP23S17PinIdx::B7>::s_IODIRBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B7)) : 0) +
-        (Pin<MCP23S17PinIdx::A0>::s_IODIRBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A0)) : 0) +
-        (Pin<MCP23S17PinIdx::A1>::s_IODIRBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A1)) : 0) +
-        (Pin<MCP23S17PinIdx::A2>::s_IODIRBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A2)) : 0) +
-        (Pin<MCP23S17PinIdx::A3>::s_IODIRBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A3)) : 0) +
-        (Pin<MCP23S17PinIdx::A4>::s_IODIRBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A4)) : 0) +
-        (Pin<MCP23S17PinIdx::A5>::s_IODIRBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A5)) : 0) +
-        (Pin<MCP23S17PinIdx::A6>::s_IODIRBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A6)) : 0) +
-        (Pin<MCP23S17PinIdx::A7>::s_IODIRBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A7)) : 0));
-        
-        writeRegisterPair(IPOLA,
-        (Pin<MCP23S17PinIdx::B0>::s_IPOLBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B0)) : 0) +
-        (Pin<MCP23S17PinIdx::B1>::s_IPOLBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B1)) : 0) +
-        (Pin<MCP23S17PinIdx::B2>::s_IPOLBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B2)) : 0) +
-        (Pin<MCP23S17PinIdx::B3>::s_IPOLBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B3)) : 0) +
-        (Pin<MCP23S17PinIdx::B4>::s_IPOLBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B4)) : 0) +
-        (Pin<MCP23S17PinIdx::B5>::s_IPOLBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B5)) : 0) +
-        (Pin<MCP23S17PinIdx::B6>::s_IPOLBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B6)) : 0) +
-        (Pin<MCP23S17PinIdx::B7>::s_IPOLBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B7)) : 0) +
-        (Pin<MCP23S17PinIdx::A0>::s_IPOLBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A0)) : 0) +
-        (Pin<MCP23S17PinIdx::A1>::s_IPOLBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A1)) : 0) +
-        (Pin<MCP23S17PinIdx::A2>::s_IPOLBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A2)) : 0) +
-        (Pin<MCP23S17PinIdx::A3>::s_IPOLBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A3)) : 0) +
-        (Pin<MCP23S17PinIdx::A4>::s_IPOLBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A4)) : 0) +
-        (Pin<MCP23S17PinIdx::A5>::s_IPOLBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A5)) : 0) +
-        (Pin<MCP23S17PinIdx::A6>::s_IPOLBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A6)) : 0) +
-        (Pin<MCP23S17PinIdx::A7>::s_IPOLBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A7)) : 0));
-        
-        writeRegisterPair(GPINTENA,
-        (Pin<MCP23S17PinIdx::B0>::s_GPINTENBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B0)) : 0) +
-        (Pin<MCP23S17PinIdx::B1>::s_GPINTENBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B1)) : 0) +
-        (Pin<MCP23S17PinIdx::B2>::s_GPINTENBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B2)) : 0) +
-        (Pin<MCP23S17PinIdx::B3>::s_GPINTENBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B3)) : 0) +
-        (Pin<MCP23S17PinIdx::B4>::s_GPINTENBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B4)) : 0) +
-        (Pin<MCP23S17PinIdx::B5>::s_GPINTENBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B5)) : 0) +
-        (Pin<MCP23S17PinIdx::B6>::s_GPINTENBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B6)) : 0) +
-        (Pin<MCP23S17PinIdx::B7>::s_GPINTENBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B7)) : 0) +
-        (Pin<MCP23S17PinIdx::A0>::s_GPINTENBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A0)) : 0) +
-        (Pin<MCP23S17PinIdx::A1>::s_GPINTENBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A1)) : 0) +
-        (Pin<MCP23S17PinIdx::A2>::s_GPINTENBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A2)) : 0) +
-        (Pin<MCP23S17PinIdx::A3>::s_GPINTENBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A3)) : 0) +
-        (Pin<MCP23S17PinIdx::A4>::s_GPINTENBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A4)) : 0) +
-        (Pin<MCP23S17PinIdx::A5>::s_GPINTENBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A5)) : 0) +
-        (Pin<MCP23S17PinIdx::A6>::s_GPINTENBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A6)) : 0) +
-        (Pin<MCP23S17PinIdx::A7>::s_GPINTENBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A7)) : 0));
-        
-        writeRegisterPair(DEFVALA,
-        (Pin<MCP23S17PinIdx::B0>::s_DEFVALBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B0)) : 0) +
-        (Pin<MCP23S17PinIdx::B1>::s_DEFVALBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B1)) : 0) +
-        (Pin<MCP23S17PinIdx::B2>::s_DEFVALBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B2)) : 0) +
-        (Pin<MCP23S17PinIdx::B3>::s_DEFVALBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B3)) : 0) +
-        (Pin<MCP23S17PinIdx::B4>::s_DEFVALBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B4)) : 0) +
-        (Pin<MCP23S17PinIdx::B5>::s_DEFVALBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B5)) : 0) +
-        (Pin<MCP23S17PinIdx::B6>::s_DEFVALBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B6)) : 0) +
-        (Pin<MCP23S17PinIdx::B7>::s_DEFVALBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B7)) : 0) +
-        (Pin<MCP23S17PinIdx::A0>::s_DEFVALBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A0)) : 0) +
-        (Pin<MCP23S17PinIdx::A1>::s_DEFVALBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A1)) : 0) +
-        (Pin<MCP23S17PinIdx::A2>::s_DEFVALBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A2)) : 0) +
-        (Pin<MCP23S17PinIdx::A3>::s_DEFVALBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A3)) : 0) +
-        (Pin<MCP23S17PinIdx::A4>::s_DEFVALBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A4)) : 0) +
-        (Pin<MCP23S17PinIdx::A5>::s_DEFVALBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A5)) : 0) +
-        (Pin<MCP23S17PinIdx::A6>::s_DEFVALBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A6)) : 0) +
-        (Pin<MCP23S17PinIdx::A7>::s_DEFVALBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A7)) : 0));
-        
-        writeRegisterPair(INTCONA,
-        (Pin<MCP23S17PinIdx::B0>::s_INTCONBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B0)) : 0) +
-        (Pin<MCP23S17PinIdx::B1>::s_INTCONBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B1)) : 0) +
-        (Pin<MCP23S17PinIdx::B2>::s_INTCONBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B2)) : 0) +
-        (Pin<MCP23S17PinIdx::B3>::s_INTCONBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B3)) : 0) +
-        (Pin<MCP23S17PinIdx::B4>::s_INTCONBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B4)) : 0) +
-        (Pin<MCP23S17PinIdx::B5>::s_INTCONBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B5)) : 0) +
-        (Pin<MCP23S17PinIdx::B6>::s_INTCONBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B6)) : 0) +
-        (Pin<MCP23S17PinIdx::B7>::s_INTCONBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B7)) : 0) +
-        (Pin<MCP23S17PinIdx::A0>::s_INTCONBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A0)) : 0) +
-        (Pin<MCP23S17PinIdx::A1>::s_INTCONBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A1)) : 0) +
-        (Pin<MCP23S17PinIdx::A2>::s_INTCONBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A2)) : 0) +
-        (Pin<MCP23S17PinIdx::A3>::s_INTCONBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A3)) : 0) +
-        (Pin<MCP23S17PinIdx::A4>::s_INTCONBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A4)) : 0) +
-        (Pin<MCP23S17PinIdx::A5>::s_INTCONBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A5)) : 0) +
-        (Pin<MCP23S17PinIdx::A6>::s_INTCONBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A6)) : 0) +
-        (Pin<MCP23S17PinIdx::A7>::s_INTCONBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A7)) : 0));
-        
-        writeRegisterPair(GPPUA,
-        (Pin<MCP23S17PinIdx::B0>::s_GPPUBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B0)) : 0) +
-        (Pin<MCP23S17PinIdx::B1>::s_GPPUBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B1)) : 0) +
-        (Pin<MCP23S17PinIdx::B2>::s_GPPUBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B2)) : 0) +
-        (Pin<MCP23S17PinIdx::B3>::s_GPPUBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B3)) : 0) +
-        (Pin<MCP23S17PinIdx::B4>::s_GPPUBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B4)) : 0) +
-        (Pin<MCP23S17PinIdx::B5>::s_GPPUBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B5)) : 0) +
-        (Pin<MCP23S17PinIdx::B6>::s_GPPUBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B6)) : 0) +
-        (Pin<MCP23S17PinIdx::B7>::s_GPPUBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::B7)) : 0) +
-        (Pin<MCP23S17PinIdx::A0>::s_GPPUBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A0)) : 0) +
-        (Pin<MCP23S17PinIdx::A1>::s_GPPUBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A1)) : 0) +
-        (Pin<MCP23S17PinIdx::A2>::s_GPPUBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A2)) : 0) +
-        (Pin<MCP23S17PinIdx::A3>::s_GPPUBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A3)) : 0) +
-        (Pin<MCP23S17PinIdx::A4>::s_GPPUBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A4)) : 0) +
-        (Pin<MCP23S17PinIdx::A5>::s_GPPUBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A5)) : 0) +
-        (Pin<MCP23S17PinIdx::A6>::s_GPPUBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A6)) : 0) +
-        (Pin<MCP23S17PinIdx::A7>::s_GPPUBit ? _BV(static_cast<uint16_t>(MCP23S17PinIdx::A7)) : 0));
-        
-        reArmInterrupt();
+        return sizeof...(Device);
     }
-    
+
     /**
-    @brief Callback for MCP23xxx interrupt
+    @brief Initialization of all devices
     */
-    static void onInterrupt() __attribute__((always_inline))
+    static void init()
     {
-        // Read interrupt flags and propagate interrupt to corresponding pin class
-        const uint16_t INTF = readRegisterPair(INTFA);
+        static_assert(hasUniqueAddresses(), "Hardware addresses must be unique");
         
-        if (INTF & _BV(static_cast<uint16_t>(MCP23S17PinIdx::B0)))
-        {
-            Pin<MCP23S17PinIdx::B0>::notify();
-        }
-        
-        if (INTF & _BV(static_cast<uint16_t>(MCP23S17PinIdx::B1)))
-        {
-            Pin<MCP23S17PinIdx::B1>::notify();
-        }
-        
-        if (INTF & _BV(static_cast<uint16_t>(MCP23S17PinIdx::B2)))
-        {
-            Pin<MCP23S17PinIdx::B2>::notify();
-        }
-        
-        if (INTF & _BV(static_cast<uint16_t>(MCP23S17PinIdx::B3)))
-        {
-            Pin<MCP23S17PinIdx::B3>::notify();
-        }
-        
-        if (INTF & _BV(static_cast<uint16_t>(MCP23S17PinIdx::B4)))
-        {
-            Pin<MCP23S17PinIdx::B4>::notify();
-        }
-        
-        if (INTF & _BV(static_cast<uint16_t>(MCP23S17PinIdx::B5)))
-        {
-            Pin<MCP23S17PinIdx::B5>::notify();
-        }
-        
-        if (INTF & _BV(static_cast<uint16_t>(MCP23S17PinIdx::B6)))
-        {
-            Pin<MCP23S17PinIdx::B6>::notify();
-        }
-        
-        if (INTF & _BV(static_cast<uint16_t>(MCP23S17PinIdx::B7)))
-        {
-            Pin<MCP23S17PinIdx::B7>::notify();
-        }
-        
-        if (INTF & _BV(static_cast<uint16_t>(MCP23S17PinIdx::A0)))
-        {
-            Pin<MCP23S17PinIdx::A0>::notify();
-        }
-        
-        if (INTF & _BV(static_cast<uint16_t>(MCP23S17PinIdx::A1)))
-        {
-            Pin<MCP23S17PinIdx::A1>::notify();
-        }
-        
-        if (INTF & _BV(static_cast<uint16_t>(MCP23S17PinIdx::A2)))
-        {
-            Pin<MCP23S17PinIdx::A2>::notify();
-        }
-        
-        if (INTF & _BV(static_cast<uint16_t>(MCP23S17PinIdx::A3)))
-        {
-            Pin<MCP23S17PinIdx::A3>::notify();
-        }
-        
-        if (INTF & _BV(static_cast<uint16_t>(MCP23S17PinIdx::A4)))
-        {
-            Pin<MCP23S17PinIdx::A4>::notify();
-        }
-        
-        if (INTF & _BV(static_cast<uint16_t>(MCP23S17PinIdx::A5)))
-        {
-            Pin<MCP23S17PinIdx::A5>::notify();
-        }
-        
-        if (INTF & _BV(static_cast<uint16_t>(MCP23S17PinIdx::A6)))
-        {
-            Pin<MCP23S17PinIdx::A6>::notify();
-        }
-        
-        if (INTF & _BV(static_cast<uint16_t>(MCP23S17PinIdx::A7)))
-        {
-            Pin<MCP23S17PinIdx::A7>::notify();
-        }
+        (Device::init(false, true), ...);
     }
 
     /**
-    @brief Re-Arm the interrupt
-    */
-    static void reArmInterrupt()
-    {
-        // Reading the INTCAP register re-arms the interrupt
-        readRegisterPair(INTCAPA);
-    }
-    
-    /**
-    @brief Read I/O port A+B
+    @brief Callback for the shared interrupt line
+    Interrupt flags of all devices with interrupt pins are read in one pass. Devices without interrupt pins are skipped at compile time
     */
-    static uint16_t read()
+    static void onInterrupt()
     {
-        return readRegisterPair(GPIOA);
+        (Device::onInterrupt(), ...);
     }
-    
+
     /**
-    @brief Read I/O port A
+    @brief Timer tick for time-based pin types of all devices
     */
-    static uint8_t readA()
+    static void tick()
     {
-        return readRegister(GPIOA);
+        (Device::tick(), ...);
     }
-    
+
     /**
-    @brief Read I/O port B
+    @brief Read I/O ports A+B of all devices
+    @param values Array of getNofDevices() port values in order of the Device pack
     */
-    static uint8_t readB()
-    {
-        return readRegister(GPIOB);
-    }
-       
-    private:
-    
-    static constexpr void checkConfig()
-    {
-        ///@todo Doppelte Benutzung von pins checken
-    }
-
-    // Register definitions for BANK MODE == 0
-    enum
-    {
-        IODIRA = 0x00,
-        IODIRB = 0x01,
-        IPOLA = 0x02,
-        IPOLB = 0x03,
-        GPINTENA = 0x04,
-        GPINTENB = 0x05,
-        DEFVALA = 0x06,
-        DEFVALB = 0x07,
-        INTCONA = 0x08,
-        INTCONB = 0x09,
-        IOCON = 0x0A,
-        //IOCON = 0x0B,
-        GPPUA = 0x0C,
-        GPPUB = 0x0D,
-        INTFA = 0x0E,
-        INTFB = 0x0F,
-        INTCAPA = 0x10,
-        INTCAPB = 0x11,
-        GPIOA = 0x12,
-        GPIOB = 0x13,
-        OLATA = 0x14,
-        OLATB = 0x15
-    };
-
-    // Op codes
-    enum
-    {
-        OPCODE_WRITE = 0b01000000,
-        OPCODE_READ = 0b01000001
-    };
-
-    // IOCON register bits
-    enum
-    {
-        INTPOL = 1,
-        ODR = 2,
-        HAEN = 3,
-        DISSLW = 4,
-        SEQOP = 5,
-        MIRROR = 6,
-        BANK = 7
-    };
-    
-    // Write value to register
-    static void writeRegister(const uint8_t t_registerAddress, const uint8_t value)
-    {
-        // Enable device (active low)
-        SSPin::low();
-        
-        // Transfer opcode
-        SPIMaster::put(OPCODE_WRITE);
-        
-        // Transfer register address
-        SPIMaster::put(t_registerAddress);
-        
-        // Transfer register value
-        SPIMaster::put(value);
-        
-        // Disable device (active low)
-        SSPin::high();
-    }
-
-    // Read value from register
-    static uint8_t readRegister(const uint8_t t_registerAddress)
+    static void read(uint16_t * values)
     {
-        // Enable device (active low)
-        SSPin::low();
-        
-        // Transfer opcode
-        SPIMaster::put(OPCODE_READ);
-        
-        // Transfer register address
-        SPIMaster::put(t_registerAddress);
-        
-        // Transfer register value
-        const uint8_t value = SPIMaster::get();
-        
-        // Disable device (active low)
-        SSPin::high();
-
-        return value;
+        ((*values++ = Device::read()), ...);
     }
 
-    // Write value to register pair
-    static void writeRegisterPair(const uint8_t t_registerAddress, const uint16_t value)
-    {
-        // Enable device (active low)
-        SSPin::low();
-        
-        // Transfer opcode
-        SPIMaster::put(OPCODE_WRITE);
-        
-        // Transfer register address
-        SPIMaster::put(t_registerAddress);
-        
-        // Transfer register value A (MSB)
-        SPIMaster::put(value >> 8);
-        
-        // Transfer register value B (LSB)
-        SPIMaster::put(value);
-        
-        // Disable device (active low)
-        SSPin::high();
-    }
+    private:
 
-    // Read value from register pair
-    static uint16_t readRegisterPair(const uint8_t t_registerAddress)
+    static constexpr bool hasUniqueAddresses()
     {
-        // Enable device (active low)
-        SSPin::low();
-        
-        // Transfer opcode
-        SPIMaster::put(OPCODE_READ);
-        
-        // Transfer register address
-        SPIMaster::put(t_registerAddress);
-        
-        // Transfer register value A (MSB)
-        const uint16_t valueA = SPIMaster::get();
-
-        // Transfer register value B (LSB)
-        const uint16_t valueB = SPIMaster::get();
-        
-        // Disable device (active low)
-        SSPin::high();
+        const uint8_t addresses[] = {Device::getHardwareAddress() ...};
+        uint8_t usedAddresses = 0;
+        for (const uint8_t address : addresses)
+        {
+            if (usedAddresses & _BV(address))
+            {
+                return false;
+            }
+            usedAddresses |= _BV(address);
+        }
 
-        return (valueA << 8) + valueB;
+        return true;
     }
 };
 
@@ -21,6 +21,7 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 #include <stdint.h>
 #include <stdbool.h>
 #include <functional.h>
+#include "ring_buffer.h"
 
 ///@brief Pin type of MCP23xxx pins
 enum class MCP23xxxPinType
@@ -33,8 +34,178 @@ enum class MCP23xxxPinType
     SWITCH_TOGGLE, // Push-button switch with interrupts for button down and button up
     ROTENC_PHASE_A, // Rotary encoder phase A generating the interrupt
     ROTENC_PHASE_B, // Rotary encoder phase B indicating the direction of rotation
+    SWITCH_DEBOUNCED, // Debounced push-button switch
+    SWITCH_TOGGLE_DEBOUNCED, // Debounced push-button switch with interrupts for button down and button up
+    ROTENC_QUAD_X1_A, // Rotary encoder phase A of a full quadrature decoder, one step per cycle
+    ROTENC_QUAD_X2_A, // Rotary encoder phase A of a full quadrature decoder, two steps per cycle
+    ROTENC_QUAD_X4_A, // Rotary encoder phase A of a full quadrature decoder, four steps per cycle
+    ROTENC_QUAD_B, // Rotary encoder phase B of a full quadrature decoder, must be connected to the pin following phase A
 };
 
+// Debounce time of debounced switches in timer ticks, see MCP23S17::tick()
+#ifndef MCP23XXX_DEBOUNCE_TICKS
+#define MCP23XXX_DEBOUNCE_TICKS 10
+#endif
+
+/**
+@brief Callback policy for MCP23xxx pins (Default)
+A type-erased callback is registered for each pin at run time and executed directly from the interrupt handler
+*/
+struct MCP23xxxDynamicCallback
+{
+    /**
+    @brief Callback storage for one pin
+    @tparam PinOnDevice Register-level driver class for underlying physical pin
+    @tparam Signature Callback signature
+    */
+    template <typename PinOnDevice, typename Signature>
+    class Callback
+    {
+        public:
+
+        /**
+        Register a callback
+        @param callback Callback to be registered
+        */
+        static void registerCallback(auto&& callback)
+        {
+            s_callback = callback;
+        }
+
+        protected:
+
+        template <typename ... Args>
+        __attribute__((always_inline)) static void invoke(const Args ... args)
+        {
+            s_callback(args ...);
+        }
+
+        private:
+
+        static function<Signature> s_callback;
+    };
+};
+
+// Static initialization
+template <typename PinOnDevice, typename Signature>
+function<Signature> MCP23xxxDynamicCallback::Callback<PinOnDevice, Signature>::s_callback;
+
+/**
+@brief Callback policy for MCP23xxx pins (Static)
+A function is bound at compile time and called directly from the interrupt handler. No callback storage is needed
+@tparam t_function Function to be called. The signature has to match the pin type, i.e. void() or void(bool)
+*/
+template <auto t_function>
+struct MCP23xxxStaticCallback
+{
+    template <typename PinOnDevice, typename Signature>
+    class Callback
+    {
+        protected:
+
+        template <typename ... Args>
+        __attribute__((always_inline)) static void invoke(const Args ... args)
+        {
+            t_function(args ...);
+        }
+    };
+};
+
+/**
+@brief Pin event stored by MCP23xxxDeferredCallback
+@tparam Timestamp Data type of time stamp
+*/
+template <typename Timestamp>
+struct MCP23xxxEvent
+{
+    uint8_t hardwareAddress; // Hardware address of the device (MCP23XXX_NO_HARDWARE_ADDRESS if hardware addressing is not used), so events of multiple devices on one bus can be told apart
+    uint8_t pinIdx; // Index of the pin on its device
+    bool value; // Callback argument, i.e. logical state of the pin or direction of rotation. Always true for callbacks without argument
+    Timestamp timestamp; // Time stamp taken when the interrupt has been handled
+};
+
+/**
+@brief Callback policy for MCP23xxx pins (Deferred)
+Instead of executing a callback in the interrupt handler, a compact event is pushed into a lock-free ring buffer, which can be drained later, e.g. by the main loop.
+This keeps the interrupt handler short and bounded in time
+@tparam TickSource Class implementing a static method now() returning a time stamp, e.g. a timer counter
+@tparam t_capacity Number of events to be stored (power of two, 1..128)
+@note All pins using the same specialization share one event queue, events are identified by the hardware address of the device and the pin index. Devices without hardware address connected to different SS pins should use different specializations (e.g. different capacities). Events will be dropped if the queue is full
+*/
+template <typename TickSource, uint8_t t_capacity = 16>
+class MCP23xxxDeferredCallback
+{
+    public:
+
+    /// @brief Event data type
+    typedef MCP23xxxEvent<decltype(TickSource::now())> Event;
+
+    /**
+    @brief Fetch the oldest event
+    @param event Event to be filled
+    @result false if there is no pending event
+    */
+    static bool pop(Event & event)
+    {
+        if (s_events.empty())
+        {
+            return false;
+        }
+
+        event = s_events.front();
+        s_events.pop();
+        return true;
+    }
+
+    /**
+    @brief Check if events have been dropped since the last call
+    @result true if events have been dropped
+    */
+    static bool hasOverflowed()
+    {
+        const bool overflow = s_overflow;
+        s_overflow = false;
+        return overflow;
+    }
+
+    template <typename PinOnDevice, typename Signature>
+    class Callback
+    {
+        protected:
+
+        __attribute__((always_inline)) static void invoke()
+        {
+            push(PinOnDevice::getHardwareAddress(), PinOnDevice::getPinIndex(), true);
+        }
+
+        __attribute__((always_inline)) static void invoke(const bool value)
+        {
+            push(PinOnDevice::getHardwareAddress(), PinOnDevice::getPinIndex(), value);
+        }
+    };
+
+    private:
+
+    static void push(const uint8_t hardwareAddress, const uint8_t pinIdx, const bool value)
+    {
+        if (!s_events.push(Event{hardwareAddress, pinIdx, value, TickSource::now()}))
+        {
+            s_overflow = true;
+        }
+    }
+
+    static RingBuffer<Event, t_capacity> s_events;
+    static volatile bool s_overflow;
+};
+
+// Static initialization
+template <typename TickSource, uint8_t t_capacity>
+RingBuffer<typename MCP23xxxDeferredCallback<TickSource, t_capacity>::Event, t_capacity> MCP23xxxDeferredCallback<TickSource, t_capacity>::s_events;
+
+// Static initialization
+template <typename TickSource, uint8_t t_capacity>
+volatile bool MCP23xxxDeferredCallback<TickSource, t_capacity>::s_overflow = false;
+
 /**
 @brief Driver for MCP23xxx family port expander
 MCP23xxx GP I/O pins can be used in a flexible way.
@@ -44,6 +215,8 @@ Logical pin drivers are provided for the following pin types:
 - Push-button: A registered callback method will be executed on button push
 - Rotary encoder phase A: A registered callback method will be executed on a rising edge of phase A. Direction of rotation can be determined by reading  a corresponding phase B pin
 - Rotary encoder phase B: This pin retains its logical state on a an interrupt triggered by rotary encoder phase A. Depending on the actual encoder, logical state low and high correspond to clockwise or counter-clockwise rotation of the rotary encoder
+- Debounced push-button: A registered callback method will be executed once per button push (and release). Further edges are ignored for MCP23XXX_DEBOUNCE_TICKS timer ticks
+- Quadrature rotary encoder: Both phases generate interrupts and are decoded by a full state table from the captured port values, so no step is missed. A registered callback method will be executed with the direction of rotation once per one, two or four state transitions
 */
 class MCP23xxx
 {
@@ -51,10 +224,11 @@ class MCP23xxx
 
     /**
     @brief Pin configuration class (Default)
-    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO() and writeOLAT(bool)
+    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO(), writeOLAT(bool) and isSet(uint16_t)
     @tparam t_PinType Pin type
+    @tparam CallbackPolicy Callback policy for pin types with callbacks, i.e. MCP23xxxDynamicCallback, MCP23xxxStaticCallback or MCP23xxxDeferredCallback
     */
-    template <typename PinOnDevice, MCP23xxxPinType t_PinType>
+    template <typename PinOnDevice, MCP23xxxPinType t_PinType, typename CallbackPolicy = MCP23xxxDynamicCallback>
     class Pin
     {
         public:
@@ -66,19 +240,40 @@ class MCP23xxx
         static constexpr bool s_INTCONBit = false;
         static constexpr bool s_GPPUBit = false;
 
-        static void notify() __attribute__((always_inline))
+        static void notify(const uint16_t, const uint16_t) __attribute__((always_inline))
         {} // Dummy
     };
 
     /**
     @brief Pin configuration class (Generic output pin)
-    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO() and writeOLAT(bool)
+    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO(), writeOLAT(bool) and isSet(uint16_t)
     */
-    template <typename PinOnDevice>
-    class Pin<PinOnDevice, MCP23xxxPinType::OUTPUT> : PinOnDevice
+    template <typename PinOnDevice, typename CallbackPolicy>
+    class Pin<PinOnDevice, MCP23xxxPinType::OUTPUT, CallbackPolicy> : PinOnDevice
     {
         public:
 
+        /**
+        @brief Set logical state of the output pin
+        @param value Logical state
+        */
+        static void write(const bool value) __attribute__((always_inline))
+        {
+            PinOnDevice::writeOLAT(value);
+        }
+
+        /// @brief Set output pin high
+        static void high() __attribute__((always_inline))
+        {
+            PinOnDevice::writeOLAT(true);
+        }
+
+        /// @brief Set output pin low
+        static void low() __attribute__((always_inline))
+        {
+            PinOnDevice::writeOLAT(false);
+        }
+
         static constexpr bool s_IODIRBit = false;
         static constexpr bool s_IPOLBit = false;
         static constexpr bool s_GPINTENBit = false;
@@ -86,16 +281,16 @@ class MCP23xxx
         static constexpr bool s_INTCONBit = false;
         static constexpr bool s_GPPUBit = false;
 
-        static void notify() __attribute__((always_inline))
+        static void notify(const uint16_t, const uint16_t) __attribute__((always_inline))
         {} // Dummy
     };
 
     /**
     @brief Pin configuration class (Generic input pin)
-    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO() and writeOLAT(bool)
+    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO(), writeOLAT(bool) and isSet(uint16_t)
     */
-    template <typename PinOnDevice>
-    class Pin<PinOnDevice, MCP23xxxPinType::INPUT> : PinOnDevice
+    template <typename PinOnDevice, typename CallbackPolicy>
+    class Pin<PinOnDevice, MCP23xxxPinType::INPUT, CallbackPolicy> : PinOnDevice
     {
         public:
         
@@ -106,16 +301,16 @@ class MCP23xxx
         static constexpr bool s_INTCONBit = false;
         static constexpr bool s_GPPUBit = false;
 
-        static void notify() __attribute__((always_inline))
+        static void notify(const uint16_t, const uint16_t) __attribute__((always_inline))
         {} // Dummy
     };
 
     /**
     @brief Pin configuration class (Generic input pin with pull-up enabled)
-    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO() and writeOLAT(bool)
+    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO(), writeOLAT(bool) and isSet(uint16_t)
     */
-    template <typename PinOnDevice>
-    class Pin<PinOnDevice, MCP23xxxPinType::INPUT_PU> : PinOnDevice
+    template <typename PinOnDevice, typename CallbackPolicy>
+    class Pin<PinOnDevice, MCP23xxxPinType::INPUT_PU, CallbackPolicy> : PinOnDevice
     {
         public:
         
@@ -126,28 +321,19 @@ class MCP23xxx
         static constexpr bool s_INTCONBit = false;
         static constexpr bool s_GPPUBit = true;
 
-        static void notify() __attribute__((always_inline))
+        static void notify(const uint16_t, const uint16_t) __attribute__((always_inline))
         {} // Dummy
     };
 
     /**
     @brief Pin configuration class (Push-button switch)
-    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO() and writeOLAT(bool)
+    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO(), writeOLAT(bool) and isSet(uint16_t)
     */
-    template <typename PinOnDevice>
-    class Pin<PinOnDevice, MCP23xxxPinType::SWITCH> : PinOnDevice
+    template <typename PinOnDevice, typename CallbackPolicy>
+    class Pin<PinOnDevice, MCP23xxxPinType::SWITCH, CallbackPolicy> : PinOnDevice, public CallbackPolicy::template Callback<PinOnDevice, void()>
     {
         public:
         
-        /**
-        Register a callback for transition of rotary encoder phase A
-        @param callback Callback to be registered
-        */
-        static void registerCallback(auto&& callback)
-        {
-            s_callback = callback;
-        }
-        
         static constexpr bool s_IODIRBit = true;
         static constexpr bool s_IPOLBit = true; // Switch is connected to ground
         static constexpr bool s_GPINTENBit = true;
@@ -155,35 +341,24 @@ class MCP23xxx
         static constexpr bool s_INTCONBit = false;
         static constexpr bool s_GPPUBit = true;
 
-        static function<void()> s_callback;
-        
-        static void notify() __attribute__((always_inline))
+        static void notify(const uint16_t INTF, const uint16_t INTCAP) __attribute__((always_inline))
         {
-            if (PinOnDevice::readINTCAP())
+            if (PinOnDevice::isSet(INTF) && PinOnDevice::isSet(INTCAP))
             {
-                s_callback();
+                CallbackPolicy::template Callback<PinOnDevice, void()>::invoke();
             }
         }
     };
 
     /**
     @brief Pin configuration class (Push-button switch)
-    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO() and writeOLAT(bool)
+    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO(), writeOLAT(bool) and isSet(uint16_t)
     */
-    template <typename PinOnDevice>
-    class Pin<PinOnDevice, MCP23xxxPinType::SWITCH_TOGGLE> : PinOnDevice
+    template <typename PinOnDevice, typename CallbackPolicy>
+    class Pin<PinOnDevice, MCP23xxxPinType::SWITCH_TOGGLE, CallbackPolicy> : PinOnDevice, public CallbackPolicy::template Callback<PinOnDevice, void(const bool)>
     {
         public:
         
-        /**
-        Register a callback for transition of rotary encoder phase A
-        @param callback Callback to be registered
-        */
-        static void registerCallback(auto&& callback)
-        {
-            s_callback = callback;
-        }
-        
         static constexpr bool s_IODIRBit = true;
         static constexpr bool s_IPOLBit = true; // Switch is connected to ground
         static constexpr bool s_GPINTENBit = true;
@@ -191,34 +366,25 @@ class MCP23xxx
         static constexpr bool s_INTCONBit = false;
         static constexpr bool s_GPPUBit = true;
 
-        static function<void(const bool)> s_callback;
-        
-        static void notify() __attribute__((always_inline))
+        static void notify(const uint16_t INTF, const uint16_t INTCAP) __attribute__((always_inline))
         {
-            s_callback(PinOnDevice::readINTCAP());
+            if (PinOnDevice::isSet(INTF))
+            {
+                CallbackPolicy::template Callback<PinOnDevice, void(const bool)>::invoke(PinOnDevice::isSet(INTCAP));
+            }
         }
     };
 
     /**
     @brief Pin configuration class (Rotary encoder phase A generating the interrupt)
-    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO() and writeOLAT(bool)
+    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO(), writeOLAT(bool) and isSet(uint16_t)
     @note Both rotary encoder phases A and B must be connected to the same MCP23xxx device
     */
-    template <typename PinOnDevice>
-    class Pin<PinOnDevice, MCP23xxxPinType::ROTENC_PHASE_A> : PinOnDevice
+    template <typename PinOnDevice, typename CallbackPolicy>
+    class Pin<PinOnDevice, MCP23xxxPinType::ROTENC_PHASE_A, CallbackPolicy> : PinOnDevice, public CallbackPolicy::template Callback<PinOnDevice, void()>
     {
         public:
         
-        /**
-        Register a callback for transition of rotary encoder phase A
-        @tparam Callback Type of callback to be registered
-        @param callback Callback to be registered
-        */
-        static void registerCallback(auto&& callback)
-        {
-            s_callback = callback;
-        }
-        
         static constexpr bool s_IODIRBit = true;
         static constexpr bool s_IPOLBit = true; // Encoder phase is connected to ground
         static constexpr bool s_GPINTENBit = true;
@@ -226,25 +392,23 @@ class MCP23xxx
         static constexpr bool s_INTCONBit = false;
         static constexpr bool s_GPPUBit = true;
 
-        static function<void()> s_callback;
-        
-        static void notify() __attribute__((always_inline))
+        static void notify(const uint16_t INTF, const uint16_t INTCAP) __attribute__((always_inline))
         {
             // Notify observer on rising edge of phase A
-            if (PinOnDevice::readINTCAP())
+            if (PinOnDevice::isSet(INTF) && PinOnDevice::isSet(INTCAP))
             {
-                s_callback();
+                CallbackPolicy::template Callback<PinOnDevice, void()>::invoke();
             }
         }
     };
 
     /**
     @brief Pin configuration class (Rotary encoder phase B indicating the direction)
-    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO() and writeOLAT(bool)
+    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO(), writeOLAT(bool) and isSet(uint16_t)
     @note Both rotary encoder phases A and B must be connected to the same MCP23xxx device
     */
-    template <typename PinOnDevice>
-    class Pin<PinOnDevice, MCP23xxxPinType::ROTENC_PHASE_B> : PinOnDevice
+    template <typename PinOnDevice, typename CallbackPolicy>
+    class Pin<PinOnDevice, MCP23xxxPinType::ROTENC_PHASE_B, CallbackPolicy> : PinOnDevice
     {
         public:
         
@@ -265,21 +429,838 @@ class MCP23xxx
         static constexpr bool s_INTCONBit = false;
         static constexpr bool s_GPPUBit = true;
 
-        static void notify() __attribute__((always_inline))
+        static void notify(const uint16_t, const uint16_t) __attribute__((always_inline))
         {} // Dummy
     };
+
+    /**
+    @brief Pin configuration base class for debounced push-button switches
+    The first edge is reported immediately. Further edges are ignored for MCP23XXX_DEBOUNCE_TICKS timer ticks. If the port value read by the last interrupt differs from the reported state at the end of this period, it will be reported then.
+    The port value (GPIO) is used instead of INTCAP, as edges while the interrupt flag is still pending raise no new interrupt, so the captured state of the last interrupt may be stale
+    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO(), writeOLAT(bool) and isSet(uint16_t)
+    @tparam Callback Callback class provided by the callback policy
+    @tparam t_toggle Flag indicating if button up should also be reported by the callback argument
+    @note State is shared by notify() and tick(), so the device's onInterrupt() and tick() must not preempt each other, e.g. both are called from ISRs or both from the main loop
+    */
+    template <typename PinOnDevice, typename Callback, bool t_toggle>
+    class DebouncedSwitchPin : PinOnDevice, public Callback
+    {
+        public:
+
+        static constexpr bool s_IODIRBit = true;
+        static constexpr bool s_IPOLBit = true; // Switch is connected to ground
+        static constexpr bool s_GPINTENBit = true;
+        static constexpr bool s_DEFVALBit = false;
+        static constexpr bool s_INTCONBit = false;
+        static constexpr bool s_GPPUBit = true;
+
+        static void notify(const uint16_t INTF, const uint16_t INTCAP, const uint16_t GPIO) __attribute__((always_inline))
+        {
+            if (PinOnDevice::isSet(INTF) && s_lockout == 0)
+            {
+                report(PinOnDevice::isSet(INTCAP));
+            }
+
+            // Any interrupt of the device provides the current state, which is evaluated at the end of the lockout
+            s_pending = PinOnDevice::isSet(GPIO);
+        }
+
+        static void tick() __attribute__((always_inline))
+        {
+            // Local copy avoids repeated access to volatile member
+            const uint8_t lockout = s_lockout;
+            if (lockout != 0)
+            {
+                s_lockout = lockout - 1;
+                if (lockout == 1)
+                {
+                    report(s_pending);
+                }
+            }
+        }
+
+        private:
+
+        static void report(const bool pressed)
+        {
+            s_pending = pressed;
+            if (pressed == s_pressed)
+            {
+                return;
+            }
+
+            s_pressed = pressed;
+            s_lockout = MCP23XXX_DEBOUNCE_TICKS;
+
+            if constexpr (t_toggle)
+            {
+                Callback::invoke(pressed);
+            }
+            else if (pressed)
+            {
+                Callback::invoke();
+            }
+        }
+
+        static volatile bool s_pressed;
+        static volatile bool s_pending;
+        static volatile uint8_t s_lockout;
+    };
+
+    /**
+    @brief Pin configuration class (Debounced push-button switch)
+    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO(), writeOLAT(bool) and isSet(uint16_t)
+    */
+    template <typename PinOnDevice, typename CallbackPolicy>
+    class Pin<PinOnDevice, MCP23xxxPinType::SWITCH_DEBOUNCED, CallbackPolicy> : public DebouncedSwitchPin<PinOnDevice, typename CallbackPolicy::template Callback<PinOnDevice, void()>, false>
+    {};
+
+    /**
+    @brief Pin configuration class (Debounced push-button switch with interrupts for button down and button up)
+    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO(), writeOLAT(bool) and isSet(uint16_t)
+    */
+    template <typename PinOnDevice, typename CallbackPolicy>
+    class Pin<PinOnDevice, MCP23xxxPinType::SWITCH_TOGGLE_DEBOUNCED, CallbackPolicy> : public DebouncedSwitchPin<PinOnDevice, typename CallbackPolicy::template Callback<PinOnDevice, void(const bool)>, true>
+    {};
+
+    /**
+    @brief Pin configuration base class for phase A of a full quadrature decoder
+    Both phases generate interrupts on change. Each transition of the captured phase states (A, B) is decoded by a state table.
+    Invalid transitions (both phases changed) are ignored. The step counter is re-synchronized whenever both phases are low, i.e. in the detent position of most encoders
+    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO(), writeOLAT(bool) and isSet(uint16_t)
+    @tparam Callback Callback class provided by the callback policy. The callback argument indicates the direction of rotation. Depending on the actual encoder, true corresponds to clockwise or counter-clockwise rotation
+    @tparam t_nofTransitions Number of state transitions per reported step (1, 2 or 4)
+    @note Phase B must be configured as ROTENC_QUAD_B on the pin following phase A
+    */
+    template <typename PinOnDevice, typename Callback, int8_t t_nofTransitions>
+    class QuadratureDecoderPin : PinOnDevice, public Callback
+    {
+        static_assert(PinOnDevice::getPinIndex() + 1 < PinOnDevice::getNofPins(), "Phase B must be connected to the pin following phase A");
+
+        public:
+
+        static constexpr bool s_IODIRBit = true;
+        static constexpr bool s_IPOLBit = true; // Encoder phase is connected to ground
+        static constexpr bool s_GPINTENBit = true;
+        static constexpr bool s_DEFVALBit = false;
+        static constexpr bool s_INTCONBit = false;
+        static constexpr bool s_GPPUBit = true;
+
+        static void notify(const uint16_t INTF, const uint16_t INTCAP) __attribute__((always_inline))
+        {
+            // Phase B is located at the next bit position
+            if (PinOnDevice::isSet(INTF) || PinOnDevice::isSet(INTF >> 1))
+            {
+                decode((PinOnDevice::isSet(INTCAP) ? 0b10 : 0) | (PinOnDevice::isSet(INTCAP >> 1) ? 0b01 : 0));
+            }
+        }
+
+        private:
+
+        static void decode(const uint8_t state)
+        {
+            // Position within the Gray code cycle 00 -> 10 -> 11 -> 01 -> 00
+            const uint8_t position = state ^ (state >> 1);
+            const uint8_t delta = (s_position - position) & 0b11;
+            s_position = position;
+
+            if (delta == 0b01)
+            {
+                ++s_steps;
+            }
+            else if (delta == 0b11)
+            {
+                --s_steps;
+            }
+
+            if (s_steps >= t_nofTransitions)
+            {
+                s_steps = 0;
+                Callback::invoke(true);
+            }
+            else if (s_steps <= -t_nofTransitions)
+            {
+                s_steps = 0;
+                Callback::invoke(false);
+            }
+
+            // Re-synchronize in detent position
+            if (state == 0)
+            {
+                s_steps = 0;
+            }
+        }
+
+        static uint8_t s_position;
+        static int8_t s_steps;
+    };
+
+    /**
+    @brief Pin configuration class (Rotary encoder phase A of a full quadrature decoder, one step per cycle)
+    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO(), writeOLAT(bool) and isSet(uint16_t)
+    */
+    template <typename PinOnDevice, typename CallbackPolicy>
+    class Pin<PinOnDevice, MCP23xxxPinType::ROTENC_QUAD_X1_A, CallbackPolicy> : public QuadratureDecoderPin<PinOnDevice, typename CallbackPolicy::template Callback<PinOnDevice, void(const bool)>, 4>
+    {};
+
+    /**
+    @brief Pin configuration class (Rotary encoder phase A of a full quadrature decoder, two steps per cycle)
+    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO(), writeOLAT(bool) and isSet(uint16_t)
+    */
+    template <typename PinOnDevice, typename CallbackPolicy>
+    class Pin<PinOnDevice, MCP23xxxPinType::ROTENC_QUAD_X2_A, CallbackPolicy> : public QuadratureDecoderPin<PinOnDevice, typename CallbackPolicy::template Callback<PinOnDevice, void(const bool)>, 2>
+    {};
+
+    /**
+    @brief Pin configuration class (Rotary encoder phase A of a full quadrature decoder, four steps per cycle)
+    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO(), writeOLAT(bool) and isSet(uint16_t)
+    */
+    template <typename PinOnDevice, typename CallbackPolicy>
+    class Pin<PinOnDevice, MCP23xxxPinType::ROTENC_QUAD_X4_A, CallbackPolicy> : public QuadratureDecoderPin<PinOnDevice, typename CallbackPolicy::template Callback<PinOnDevice, void(const bool)>, 1>
+    {};
+
+    /**
+    @brief Pin configuration class (Rotary encoder phase B of a full quadrature decoder)
+    @tparam PinOnDevice Register-level driver class for underlying physical pin on actual MCP23xxx device implementing static methods readINTCAP(), readGPIO(), writeOLAT(bool) and isSet(uint16_t)
+    @note Decoding is done by the phase A pin, which must be located at the preceding pin
+    */
+    template <typename PinOnDevice, typename CallbackPolicy>
+    class Pin<PinOnDevice, MCP23xxxPinType::ROTENC_QUAD_B, CallbackPolicy> : PinOnDevice
+    {
+        public:
+
+        static constexpr bool s_IODIRBit = true;
+        static constexpr bool s_IPOLBit = true; // Encoder phase is connected to ground
+        static constexpr bool s_GPINTENBit = true;
+        static constexpr bool s_DEFVALBit = false;
+        static constexpr bool s_INTCONBit = false;
+        static constexpr bool s_GPPUBit = true;
+
+        static void notify(const uint16_t, const uint16_t) __attribute__((always_inline))
+        {} // Dummy, decoding is done by phase A
+    };
 };
 
 // Static initialization
-template <typename PinOnDevice>
-function<void()> MCP23xxx::Pin<PinOnDevice, MCP23xxxPinType::SWITCH>::s_callback;
+template <typename PinOnDevice, typename Callback, bool t_toggle>
+volatile bool MCP23xxx::DebouncedSwitchPin<PinOnDevice, Callback, t_toggle>::s_pressed = false;
+
+// Static initialization
+template <typename PinOnDevice, typename Callback, bool t_toggle>
+volatile bool MCP23xxx::DebouncedSwitchPin<PinOnDevice, Callback, t_toggle>::s_pending = false;
+
+// Static initialization
+template <typename PinOnDevice, typename Callback, bool t_toggle>
+volatile uint8_t MCP23xxx::DebouncedSwitchPin<PinOnDevice, Callback, t_toggle>::s_lockout = 0;
+
+// Static initialization
+template <typename PinOnDevice, typename Callback, int8_t t_nofTransitions>
+uint8_t MCP23xxx::QuadratureDecoderPin<PinOnDevice, Callback, t_nofTransitions>::s_position = 0;
+
+// Static initialization
+template <typename PinOnDevice, typename Callback, int8_t t_nofTransitions>
+int8_t MCP23xxx::QuadratureDecoderPin<PinOnDevice, Callback, t_nofTransitions>::s_steps = 0;
+
+/// @brief Hardware address value for MCP23xxx SPI devices not using hardware addressing (IOCON.HAEN disabled)
+constexpr uint8_t MCP23XXX_NO_HARDWARE_ADDRESS = 0xFF;
+
+/// @brief MCP23xxx IOCON register bits
+enum MCP23xxxIOCON
+{
+    MCP23XXX_INTPOL = 1,
+    MCP23XXX_ODR = 2,
+    MCP23XXX_HAEN = 3,
+    MCP23XXX_DISSLW = 4,
+    MCP23XXX_SEQOP = 5,
+    MCP23XXX_MIRROR = 6,
+    MCP23XXX_BANK = 7
+};
+
+/**
+@brief Port width policy for MCP23xxx devices with two 8 bit I/O ports A and B (MCP23S17, MCP23017)
+Registers of ports A and B are interleaved (IOCON.BANK = 0), so each register pair is accessed by one burst. Port A is transferred first and is mapped to the MSB of 16 bit register values
+*/
+struct MCP23xxxPort16
+{
+    /**
+    @brief Get the number of GP I/O pins
+    @result Number of pins
+    */
+    static constexpr uint8_t getNofPins()
+    {
+        return 16;
+    }
+
+    /**
+    @brief Get the number of bytes per register
+    @result Number of bytes
+    */
+    static constexpr uint8_t getNofBytes()
+    {
+        return 2;
+    }
+
+    /**
+    @brief Get the address of the first byte of a register
+    @param reg Register index IODIR (0) .. OLAT (10), see MCP23xxxDevice
+    @result Register address
+    */
+    static constexpr uint8_t getRegisterAddress(const uint8_t reg)
+    {
+        return reg << 1;
+    }
+
+    /**
+    @brief Get the address of the register byte containing a pin
+    @param reg Register index IODIR (0) .. OLAT (10), see MCP23xxxDevice
+    @param pinIdx Pin index (B0..B7 = 0..7, A0..A7 = 8..15)
+    @result Register address
+    */
+    static constexpr uint8_t getByteAddress(const uint8_t reg, const uint8_t pinIdx)
+    {
+        return getRegisterAddress(reg) + ((pinIdx < 8) ? 1 : 0);
+    }
+
+    /**
+    @brief Get the IOCON bits required by the port width
+    @result IOCON bits. Interrupt outputs INTA and INTB are mirrored, so one interrupt line is sufficient
+    */
+    static constexpr uint8_t getIOCONFlags()
+    {
+        return _BV(MCP23XXX_MIRROR);
+    }
+};
+
+/**
+@brief Port width policy for MCP23xxx devices with one 8 bit I/O port (MCP23S08, MCP23008)
+*/
+struct MCP23xxxPort8
+{
+    static constexpr uint8_t getNofPins()
+    {
+        return 8;
+    }
+
+    static constexpr uint8_t getNofBytes()
+    {
+        return 1;
+    }
+
+    static constexpr uint8_t getRegisterAddress(const uint8_t reg)
+    {
+        return reg;
+    }
+
+    static constexpr uint8_t getByteAddress(const uint8_t reg, const uint8_t)
+    {
+        return reg;
+    }
+
+    static constexpr uint8_t getIOCONFlags()
+    {
+        return 0;
+    }
+};
+
+template <typename T>
+concept PinConfiguration = requires
+{
+    T::s_pinIdx;
+    T::s_pinType;
+    typename T::CallbackPolicy;
+};
+
+/**
+@brief Generic driver for MCP23xxx family port expanders
+Register access is delegated to a transport policy, the register layout to a port width policy. All other functionality, i.e. the compile-time register image, the output latch shadow register and the interrupt dispatching, is shared by all devices.
+@tparam Transport Transport policy, e.g. MCP23xxxSPITransport or MCP23xxxI2CTransport, implementing static methods beginWrite(uint8_t), beginRead(uint8_t), put(uint8_t), get(bool), end(), enableAddressing(uint8_t, uint8_t), getIOCONFlags() and getHardwareAddress()
+@tparam PortWidth Port width policy, i.e. MCP23xxxPort16 or MCP23xxxPort8
+@tparam PinConfig Pack of pin configurations (e.g. MCP23S17PinConfig) for all used GP I/O pins
+*/
+template <typename Transport, typename PortWidth, PinConfiguration ... PinConfig>
+class MCP23xxxDevice : MCP23xxx
+{
+    private:
+
+    /**
+    @brief Register-level driver class for MCP23xxx GP I/O pin
+    @tparam t_pinIdx Pin index
+    */
+    template <uint8_t t_pinIdx>
+    class PinRegisterAccess
+    {
+        public:
+
+        static constexpr uint8_t getPinIndex()
+        {
+            return t_pinIdx;
+        }
+
+        static constexpr uint8_t getNofPins()
+        {
+            return PortWidth::getNofPins();
+        }
+
+        static constexpr uint8_t getHardwareAddress()
+        {
+            return Transport::getHardwareAddress();
+        }
+
+        protected:
+
+        static bool readINTCAP() __attribute__((always_inline))
+        {
+            // INTCAP registers are captured by onInterrupt(), so no transfer is needed
+            return isSet(s_INTCAP);
+        }
+
+        static bool isSet(const uint16_t value) __attribute__((always_inline))
+        {
+            return value & getPinMask();
+        }
+
+        static bool readGPIO() __attribute__((always_inline))
+        {
+            // Only the register byte containing the pin is read
+            return readByte(PortWidth::getByteAddress(GPIO, t_pinIdx)) & getBitmask();
+        }
+
+        static void writeOLAT(const bool bValue)
+        {
+            // Output latch is kept in a shadow register, so no read access is needed
+            writePort(getPinMask(), bValue ? getPinMask() : 0);
+        }
+
+        static constexpr uint8_t getBitmask()
+        {
+            static_assert(t_pinIdx < PortWidth::getNofPins(), "Invalid pin number");
+            return _BV(t_pinIdx & 0b111);
+        }
+
+        static constexpr uint16_t getPinMask()
+        {
+            return static_cast<uint16_t>(_BV(static_cast<uint16_t>(t_pinIdx)));
+        }
+    };
+
+    // Pin configuration of pins not contained in the PinConfig pack
+    struct UnusedPinConfig
+    {
+        static constexpr MCP23xxxPinType s_pinType = MCP23xxxPinType::UNUSED;
+        typedef MCP23xxxDynamicCallback CallbackPolicy;
+    };
+
+    // Struct selecting one of two pin configurations
+    template <bool t_first, typename FirstPinConfig, typename SecondPinConfig>
+    struct SelectPinConfig
+    {
+        typedef FirstPinConfig type;
+    };
+
+    // Struct selecting one of two pin configurations
+    // Specialization for second pin configuration
+    template <typename FirstPinConfig, typename SecondPinConfig>
+    struct SelectPinConfig<false, FirstPinConfig, SecondPinConfig>
+    {
+        typedef SecondPinConfig type;
+    };
+
+    // Struct retrieving the pin configuration for a given pin index
+    // Termination: If a configuration for given pin index does not exist, the pin is considered as unused
+    template <uint8_t t_pinIdx, typename ... PinConfigs>
+    struct PinIdxToPinConfig
+    {
+        typedef UnusedPinConfig type;
+    };
+
+    // Struct retrieving the pin configuration for a given pin index
+    template <uint8_t t_pinIdx, typename CurrentPinConfig, typename ... NextPinConfig>
+    struct PinIdxToPinConfig<t_pinIdx, CurrentPinConfig, NextPinConfig ...>
+    {
+        // Search the parameter pack for configuration of given pin index
+        typedef typename SelectPinConfig<t_pinIdx == static_cast<uint8_t>(CurrentPinConfig::s_pinIdx), CurrentPinConfig, typename PinIdxToPinConfig<t_pinIdx, NextPinConfig ...>::type>::type type;
+    };
+
+    public:
+
+    /**
+    @brief Pin interface combining pin type and register access for selected pin
+    @tparam t_pinIdx Pin index of the device, e.g. MCP23S17PinIdx
+    */
+    template <auto t_pinIdx>
+    using Pin = MCP23xxx::Pin<PinRegisterAccess<static_cast<uint8_t>(t_pinIdx)>, PinIdxToPinConfig<static_cast<uint8_t>(t_pinIdx), PinConfig ...>::type::s_pinType, typename PinIdxToPinConfig<static_cast<uint8_t>(t_pinIdx), PinConfig ...>::type::CallbackPolicy>;
+
+    /**
+    @brief Get the number of GP I/O pins
+    @result Number of pins
+    */
+    static constexpr uint8_t getNofPins()
+    {
+        return PortWidth::getNofPins();
+    }
+
+    /**
+    @brief Get the hardware address
+    @result Hardware address (pins A2..A0) or MCP23XXX_NO_HARDWARE_ADDRESS
+    */
+    static constexpr uint8_t getHardwareAddress()
+    {
+        return Transport::getHardwareAddress();
+    }
+
+    /**
+    @brief Check if any pin is configured to generate interrupts
+    @result true if onInterrupt() needs to be called
+    */
+    static constexpr bool hasInterrupts()
+    {
+        return getInterruptMask() != 0;
+    }
+
+    /**
+    @brief Initialization
+    @param intActiveHigh Flag indicating if the interrupt output is active high. This is ignored if intOpenDrain is set
+    @param intOpenDrain Flag indicating if the interrupt output is an open-drain output (active low), e.g. for wired-OR interrupt lines of multiple devices
+    @note The register image is derived from the pin configuration at compile time, so init() can also be used to cheaply restore the configuration after a device reset
+    */
+    static void init(const bool intActiveHigh = true, const bool intOpenDrain = false)
+    {
+        checkConfig(); // Will evaluate at compile time and assert in case something is wrong with the pin configuration
+
+        // Sequential operation (SEQOP cleared) for burst access to consecutive registers
+        // Interrupt output active high --> set INTPOL bit
+        const uint8_t valueIOCON = PortWidth::getIOCONFlags() | Transport::getIOCONFlags() | (intActiveHigh ? _BV(MCP23XXX_INTPOL) : 0) | (intOpenDrain ? _BV(MCP23XXX_ODR) : 0);
+
+        // Hardware addressing has to be enabled before the device responds to its address
+        Transport::enableAddressing(PortWidth::getRegisterAddress(IOCON), valueIOCON);
+
+        // IOCON is written separately first, so sequential operation is enabled even if SEQOP has been set before
+        writeByte(PortWidth::getRegisterAddress(IOCON), valueIOCON);
+
+        // Configuration registers IODIR..GPPU are written by one sequential transfer
+        writeConfiguration(valueIOCON);
+
+        // Restore output latches from shadow register
+        writeRegister(OLAT, s_OLAT);
+
+        reArmInterrupt();
+    }
+
+    /**
+    @brief Callback for MCP23xxx interrupt
+    @note Interrupt flags and captured port values are read by one sequential transfer. If any pin evaluates the current port values (e.g. debounced switches), GPIO is read by the same transfer. Only configured pins are notified
+    */
+    static void onInterrupt() __attribute__((always_inline))
+    {
+        if constexpr (!hasInterrupts())
+        {
+            return;
+        }
+
+        static_assert(PortWidth::getRegisterAddress(GPIO) == PortWidth::getRegisterAddress(INTCAP) + PortWidth::getNofBytes(), "GPIO must follow INTCAP for sequential access");
+
+        // Read INTF, INTCAP and GPIO (if needed). Reading the INTCAP or GPIO registers also re-arms the interrupt
+        Transport::beginRead(PortWidth::getRegisterAddress(INTF));
+        [[maybe_unused]] const uint16_t valueINTF = getRegister(false);
+        const uint16_t valueINTCAP = getRegister(!hasGPIOSnapshot());
+        [[maybe_unused]] const uint16_t valueGPIO = hasGPIOSnapshot() ? getRegister(true) : 0;
+        Transport::end();
+
+        s_INTCAP = valueINTCAP;
+
+        // Propagate interrupt to corresponding pin classes
+        (dispatchInterrupt<static_cast<uint8_t>(PinConfig::s_pinIdx)>(valueINTF, valueINTCAP, valueGPIO), ...);
+    }
+
+    /**
+    @brief Timer tick for time-based pin types (e.g. debounced switches)
+    This method has to be called periodically, e.g. every 1 ms from a timer ISR. No transfer is done
+    */
+    static void tick()
+    {
+        (tickPin<static_cast<uint8_t>(PinConfig::s_pinIdx)>(), ...);
+    }
+
+    /**
+    @brief Re-Arm the interrupt
+    */
+    static void reArmInterrupt()
+    {
+        // Reading the INTCAP register re-arms the interrupt
+        s_INTCAP = readRegister(INTCAP);
+    }
+
+    /**
+    @brief Read all I/O ports
+    @result Port values, i.e. A (MSB) + B (LSB) for 16 bit devices
+    */
+    static uint16_t read()
+    {
+        return readRegister(GPIO);
+    }
+
+    /**
+    @brief Read I/O port A (16 bit devices only)
+    */
+    static uint8_t readA()
+    {
+        static_assert(PortWidth::getNofPins() == 16, "Port A is only available on 16 bit devices");
+        return readByte(PortWidth::getRegisterAddress(GPIO));
+    }
+
+    /**
+    @brief Read I/O port B (16 bit devices only)
+    */
+    static uint8_t readB()
+    {
+        static_assert(PortWidth::getNofPins() == 16, "Port B is only available on 16 bit devices");
+        return readByte(PortWidth::getRegisterAddress(GPIO) + 1);
+    }
+
+    /**
+    @brief Write multiple output pins at once
+    @param mask Bit mask of pins to be written. Bit positions correspond to the pin index
+    @param value New logical state of the pins selected by mask
+    @note Only output latch registers which actually change will be written, using one transfer in total
+    */
+    static void writePort(const uint16_t mask, const uint16_t value)
+    {
+        const uint16_t valueOLAT = (s_OLAT & ~mask) | (value & mask);
+        const uint16_t changed = valueOLAT ^ s_OLAT;
+        s_OLAT = valueOLAT;
+
+        if constexpr (PortWidth::getNofBytes() == 2)
+        {
+            if ((changed & 0xFF00) && (changed & 0x00FF))
+            {
+                writeRegister(OLAT, valueOLAT);
+            }
+            else if (changed & 0xFF00)
+            {
+                writeByte(PortWidth::getRegisterAddress(OLAT), valueOLAT >> 8);
+            }
+            else if (changed & 0x00FF)
+            {
+                writeByte(PortWidth::getRegisterAddress(OLAT) + 1, valueOLAT);
+            }
+        }
+        else if (changed != 0)
+        {
+            writeByte(PortWidth::getRegisterAddress(OLAT), valueOLAT);
+        }
+    }
+
+    /**
+    @brief Get the state of all output latches
+    @result Output latches, i.e. A (MSB) + B (LSB) for 16 bit devices. Bit positions correspond to the pin index
+    @note The value is taken from the shadow register, so no transfer is needed
+    */
+    static uint16_t getOutputLatches()
+    {
+        return s_OLAT;
+    }
+
+    private:
+
+    static constexpr void checkConfig()
+    {
+        static_assert(hasUniquePins(), "Each pin must be configured only once");
+        static_assert(((static_cast<uint8_t>(PinConfig::s_pinIdx) < PortWidth::getNofPins()) && ...), "Invalid pin number");
+    }
+
+    // Check the pin configuration for duplicate pin indices
+    static constexpr bool hasUniquePins()
+    {
+        [[maybe_unused]] uint16_t usedPins = 0;
+        bool unique = true;
+        ((unique = unique && !(usedPins & getPinMask(PinConfig::s_pinIdx)), usedPins |= getPinMask(PinConfig::s_pinIdx)), ...);
+        return unique;
+    }
+
+    static constexpr uint16_t getPinMask(const auto pinIdx)
+    {
+        return static_cast<uint16_t>(_BV(static_cast<uint16_t>(pinIdx)));
+    }
+
+    // Register images derived from the pin configuration
+    static constexpr uint16_t getIODIR()
+    {
+        return ((Pin<PinConfig::s_pinIdx>::s_IODIRBit ? getPinMask(PinConfig::s_pinIdx) : 0) | ... | 0);
+    }
+
+    static constexpr uint16_t getIPOL()
+    {
+        return ((Pin<PinConfig::s_pinIdx>::s_IPOLBit ? getPinMask(PinConfig::s_pinIdx) : 0) | ... | 0);
+    }
+
+    static constexpr uint16_t getGPINTEN()
+    {
+        return ((Pin<PinConfig::s_pinIdx>::s_GPINTENBit ? getPinMask(PinConfig::s_pinIdx) : 0) | ... | 0);
+    }
+
+    static constexpr uint16_t getDEFVAL()
+    {
+        return ((Pin<PinConfig::s_pinIdx>::s_DEFVALBit ? getPinMask(PinConfig::s_pinIdx) : 0) | ... | 0);
+    }
+
+    static constexpr uint16_t getINTCON()
+    {
+        return ((Pin<PinConfig::s_pinIdx>::s_INTCONBit ? getPinMask(PinConfig::s_pinIdx) : 0) | ... | 0);
+    }
+
+    static constexpr uint16_t getGPPU()
+    {
+        return ((Pin<PinConfig::s_pinIdx>::s_GPPUBit ? getPinMask(PinConfig::s_pinIdx) : 0) | ... | 0);
+    }
+
+    // Write configuration registers IODIR..GPPU. All values except IOCON are compile-time constants
+    static void writeConfiguration(const uint8_t valueIOCON)
+    {
+        Transport::beginWrite(PortWidth::getRegisterAddress(IODIR));
+
+        // Transfer register values. Address pointer is incremented automatically
+        putRegister(getIODIR());
+        putRegister(getIPOL());
+        putRegister(getGPINTEN());
+        putRegister(getDEFVAL());
+        putRegister(getINTCON());
+        putRegister(valueIOCON * 0x0101); // Same value for both IOCON addresses of 16 bit devices
+        putRegister(getGPPU());
+
+        Transport::end();
+    }
+
+    // Bit mask of pins with interrupt enabled
+    static constexpr uint16_t getInterruptMask()
+    {
+        return getGPINTEN();
+    }
+
+    // Check if pin evaluates the port values read on an interrupt
+    template <uint8_t t_pinIdx>
+    static constexpr bool usesGPIO()
+    {
+        return requires(const uint16_t value) { Pin<t_pinIdx>::notify(value, value, value); };
+    }
+
+    // Check if any pin evaluates the port values read on an interrupt
+    static constexpr bool hasGPIOSnapshot()
+    {
+        return (usesGPIO<static_cast<uint8_t>(PinConfig::s_pinIdx)>() || ... || false);
+    }
+
+    // Notify pin about an interrupt if its interrupt flag is set
+    template <uint8_t t_pinIdx>
+    __attribute__((always_inline)) static void dispatchInterrupt(const uint16_t valueINTF, const uint16_t valueINTCAP, [[maybe_unused]] const uint16_t valueGPIO)
+    {
+        // Pins check the interrupt flags on their own, as some pin types also depend on other pins
+        if constexpr (usesGPIO<t_pinIdx>())
+        {
+            Pin<t_pinIdx>::notify(valueINTF, valueINTCAP, valueGPIO);
+        }
+        else
+        {
+            Pin<t_pinIdx>::notify(valueINTF, valueINTCAP);
+        }
+    }
+
+    // Forward timer tick to pin if needed
+    template <uint8_t t_pinIdx>
+    __attribute__((always_inline)) static void tickPin()
+    {
+        if constexpr (requires { Pin<t_pinIdx>::tick(); })
+        {
+            Pin<t_pinIdx>::tick();
+        }
+    }
+
+    // Register indices. Register addresses are provided by the port width policy
+    enum
+    {
+        IODIR = 0,
+        IPOL = 1,
+        GPINTEN = 2,
+        DEFVAL = 3,
+        INTCON = 4,
+        IOCON = 5,
+        GPPU = 6,
+        INTF = 7,
+        INTCAP = 8,
+        GPIO = 9,
+        OLAT = 10
+    };
+
+    // Transfer register value, i.e. A (MSB) + B (LSB) for 16 bit devices
+    static void putRegister(const uint16_t value) __attribute__((always_inline))
+    {
+        if constexpr (PortWidth::getNofBytes() == 2)
+        {
+            Transport::put(value >> 8);
+        }
+        Transport::put(value);
+    }
+
+    // Receive register value, i.e. A (MSB) + B (LSB) for 16 bit devices
+    static uint16_t getRegister(const bool last) __attribute__((always_inline))
+    {
+        if constexpr (PortWidth::getNofBytes() == 2)
+        {
+            const uint16_t valueA = Transport::get(false);
+            return (valueA << 8) | Transport::get(last);
+        }
+        else
+        {
+            return Transport::get(last);
+        }
+    }
+
+    // Write register
+    static void writeRegister(const uint8_t reg, const uint16_t value)
+    {
+        Transport::beginWrite(PortWidth::getRegisterAddress(reg));
+        putRegister(value);
+        Transport::end();
+    }
+
+    // Read register
+    static uint16_t readRegister(const uint8_t reg)
+    {
+        Transport::beginRead(PortWidth::getRegisterAddress(reg));
+        const uint16_t value = getRegister(true);
+        Transport::end();
+        return value;
+    }
+
+    // Write single register byte
+    static void writeByte(const uint8_t address, const uint8_t value)
+    {
+        Transport::beginWrite(address);
+        Transport::put(value);
+        Transport::end();
+    }
+
+    // Read single register byte
+    static uint8_t readByte(const uint8_t address)
+    {
+        Transport::beginRead(address);
+        const uint8_t value = Transport::get(true);
+        Transport::end();
+        return value;
+    }
+
+    // Shadow register of OLAT
+    static uint16_t s_OLAT;
+
+    // INTCAP captured by the last interrupt
+    static uint16_t s_INTCAP;
+};
 
 // Static initialization
-template <typename PinOnDevice>
-function<void(const bool)> MCP23xxx::Pin<PinOnDevice, MCP23xxxPinType::SWITCH_TOGGLE>::s_callback;
+template <typename Transport, typename PortWidth, PinConfiguration ... PinConfig>
+uint16_t MCP23xxxDevice<Transport, PortWidth, PinConfig ...>::s_OLAT = 0;
 
 // Static initialization
-template <typename PinOnDevice>
-function<void()> MCP23xxx::Pin<PinOnDevice, MCP23xxxPinType::ROTENC_PHASE_A>::s_callback;
+template <typename Transport, typename PortWidth, PinConfiguration ... PinConfig>
+uint16_t MCP23xxxDevice<Transport, PortWidth, PinConfig ...>::s_INTCAP = 0;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,272 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MCP23XXX_TRANSPORT_H
+#define MCP23XXX_TRANSPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "MCP23XXX.h"
+
+template <typename T>
+concept DrvSPIMaster = requires(uint8_t a)
+{
+    T::put(a);
+    a = T::get();
+};
+
+template <typename T>
+concept DrvGPIOPin = requires
+{
+     T::high();
+     T::low();
+};
+
+template <typename T>
+concept DrvTWIMaster = requires(uint8_t a, bool b)
+{
+    T::start(a);
+    T::put(a);
+    a = T::get(b);
+    T::stop();
+};
+
+/**
+@brief Transport policy for MCP23xxxDevice: SPI devices (MCP23S17, MCP23S08)
+A register access is one SS cycle: Opcode, register address, register values. The address pointer is incremented automatically for sequential access
+@tparam SPIMaster SPI master driver class implementing static methods put(uint8_t) and get()
+@tparam SSPin Pin driver class implementing static methods high() and low()
+@tparam t_hardwareAddress Hardware address (0..7) or MCP23XXX_NO_HARDWARE_ADDRESS. If set, IOCON.HAEN is enabled by the device initialization
+*/
+template <
+DrvSPIMaster SPIMaster,
+DrvGPIOPin SSPin,
+uint8_t t_hardwareAddress>
+class MCP23xxxSPITransport
+{
+    static_assert(t_hardwareAddress < 8 || t_hardwareAddress == MCP23XXX_NO_HARDWARE_ADDRESS, "Invalid hardware address");
+
+    public:
+
+    /**
+    @brief Get the hardware address
+    @result Hardware address or MCP23XXX_NO_HARDWARE_ADDRESS
+    */
+    static constexpr uint8_t getHardwareAddress()
+    {
+        return t_hardwareAddress;
+    }
+
+    /**
+    @brief Get the IOCON bits required by the transport
+    @result HAEN bit if hardware addressing is used
+    */
+    static constexpr uint8_t getIOCONFlags()
+    {
+        return (t_hardwareAddress != MCP23XXX_NO_HARDWARE_ADDRESS) ? _BV(MCP23XXX_HAEN) : 0;
+    }
+
+    /**
+    @brief Enable hardware addressing
+    As long as HAEN is disabled, all devices sharing the SS pin respond to address 0, so IOCON is written using address 0
+    @param address Address of IOCON register
+    @param valueIOCON IOCON value including HAEN bit
+    */
+    static void enableAddressing(const uint8_t address, const uint8_t valueIOCON)
+    {
+        if constexpr (t_hardwareAddress != MCP23XXX_NO_HARDWARE_ADDRESS)
+        {
+            // Enable device (active low)
+            SSPin::low();
+
+            SPIMaster::put(OPCODE_WRITE_BROADCAST);
+            SPIMaster::put(address);
+            SPIMaster::put(valueIOCON);
+
+            // Disable device (active low)
+            SSPin::high();
+        }
+    }
+
+    /**
+    @brief Start write access
+    @param address Address of first register
+    */
+    static void beginWrite(const uint8_t address) __attribute__((always_inline))
+    {
+        // Enable device (active low)
+        SSPin::low();
+
+        // Transfer opcode
+        SPIMaster::put(OPCODE_WRITE);
+
+        // Transfer register address
+        SPIMaster::put(address);
+    }
+
+    /**
+    @brief Start read access
+    @param address Address of first register
+    */
+    static void beginRead(const uint8_t address) __attribute__((always_inline))
+    {
+        // Enable device (active low)
+        SSPin::low();
+
+        // Transfer opcode
+        SPIMaster::put(OPCODE_READ);
+
+        // Transfer register address
+        SPIMaster::put(address);
+    }
+
+    /**
+    @brief Transfer register value
+    @param value Register value
+    */
+    static void put(const uint8_t value) __attribute__((always_inline))
+    {
+        SPIMaster::put(value);
+    }
+
+    /**
+    @brief Receive register value
+    @result Register value
+    */
+    static uint8_t get(const bool) __attribute__((always_inline))
+    {
+        return SPIMaster::get();
+    }
+
+    /**
+    @brief Finish access
+    */
+    static void end() __attribute__((always_inline))
+    {
+        // Disable device (active low)
+        SSPin::high();
+    }
+
+    private:
+
+    static constexpr uint8_t getOpcodeAddress()
+    {
+        return (t_hardwareAddress == MCP23XXX_NO_HARDWARE_ADDRESS) ? 0 : (t_hardwareAddress << 1);
+    }
+
+    // Op codes
+    enum
+    {
+        OPCODE_WRITE_BROADCAST = 0b01000000,
+        OPCODE_WRITE = 0b01000000 | getOpcodeAddress(),
+        OPCODE_READ = 0b01000001 | getOpcodeAddress()
+    };
+};
+
+/**
+@brief Transport policy for MCP23xxxDevice: I2C devices (MCP23017, MCP23008)
+A write access is START, slave address (W), register address, register values, STOP. A read access sends the register address first and continues with a repeated START, slave address (R) and register values, the last one not acknowledged
+@tparam TWIMaster TWI master driver class implementing static methods start(uint8_t) transferring START and the slave address byte, put(uint8_t), get(bool) receiving a byte followed by ACK (true) or NACK (false), and stop()
+@tparam t_hardwareAddress Hardware address A2..A0 (0..7). The slave address is 0b0100AAA
+*/
+template <
+DrvTWIMaster TWIMaster,
+uint8_t t_hardwareAddress>
+class MCP23xxxI2CTransport
+{
+    static_assert(t_hardwareAddress < 8, "Invalid hardware address");
+
+    public:
+
+    static constexpr uint8_t getHardwareAddress()
+    {
+        return t_hardwareAddress;
+    }
+
+    /**
+    @brief Get the IOCON bits required by the transport
+    @result No bits, I2C devices are always addressed
+    */
+    static constexpr uint8_t getIOCONFlags()
+    {
+        return 0;
+    }
+
+    /**
+    @brief Enable hardware addressing. Nothing to do for I2C devices
+    */
+    static void enableAddressing(const uint8_t, const uint8_t) __attribute__((always_inline))
+    {}
+
+    /**
+    @brief Start write access
+    @param address Address of first register
+    */
+    static void beginWrite(const uint8_t address) __attribute__((always_inline))
+    {
+        TWIMaster::start(SLA_W);
+
+        // Transfer register address
+        TWIMaster::put(address);
+    }
+
+    /**
+    @brief Start read access
+    @param address Address of first register
+    */
+    static void beginRead(const uint8_t address) __attribute__((always_inline))
+    {
+        TWIMaster::start(SLA_W);
+
+        // Transfer register address
+        TWIMaster::put(address);
+
+        // Repeated start, no stop in between
+        TWIMaster::start(SLA_R);
+    }
+
+    static void put(const uint8_t value) __attribute__((always_inline))
+    {
+        TWIMaster::put(value);
+    }
+
+    /**
+    @brief Receive register value
+    @param last Flag indicating the last byte of the access, which is not acknowledged
+    @result Register value
+    */
+    static uint8_t get(const bool last) __attribute__((always_inline))
+    {
+        return TWIMaster::get(!last);
+    }
+
+    static void end() __attribute__((always_inline))
+    {
+        TWIMaster::stop();
+    }
+
+    private:
+
+    // Slave address bytes
+    enum
+    {
+        SLA_W = 0b01000000 | (t_hardwareAddress << 1),
+        SLA_R = 0b01000001 | (t_hardwareAddress << 1)
+    };
+};
+
+#endif
@@ -0,0 +1,125 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef ANALOG_MULTIPLEXER_CASCADE_H
+#define ANALOG_MULTIPLEXER_CASCADE_H
+
+#include <stdint.h>
+
+/**
+@brief Cascade of two multiplexer levels with a flat channel space
+The bank level selects one of several first level multiplexers, either by a second level multiplexer or by the enable lines of a line decoder.
+All first level multiplexers share their select lines. Flat channel n is channel (n % Channel::getNofChannels()) of bank (n / Channel::getNofChannels()).
+Each level is only written if its selection changes, so stepping through the channels in Gray code order (AnalogMultiplexerGrayCodeOrder) writes one level per step only.
+Cascades can be nested to build more than two levels.
+@tparam Bank Bank selection driver class, e.g. AnalogMultiplexer, LineDecoder or AnalogMultiplexerCascade
+@tparam Channel First level multiplexer driver class, e.g. AnalogMultiplexer or AnalogMultiplexerCascade
+@note The result can be used as Mux of AnalogMultiplexerScanner
+*/
+template <typename Bank, typename Channel>
+class AnalogMultiplexerCascade
+{
+    public:
+
+    /**
+    @brief Get the number of channels of all banks
+    @result Number of channels
+    */
+    static constexpr uint8_t getNofChannels()
+    {
+        return Channel::getNofChannels() * getNofBanks();
+    }
+
+    /**
+    @brief Get the number of banks
+    @result Number of first level multiplexers
+    */
+    static constexpr uint8_t getNofBanks()
+    {
+        if constexpr (requires { Bank::nofLines(); })
+        {
+            return Bank::nofLines();
+        }
+        else
+        {
+            return Bank::getNofChannels();
+        }
+    }
+
+    /// @brief Initialization
+    static void init()
+    {
+        static_assert((Channel::getNofChannels() & (Channel::getNofChannels() - 1)) == 0, "Number of first level channels must be a power of two");
+        static_assert(static_cast<uint16_t>(Channel::getNofChannels()) * getNofBanks() <= 128, "Too many channels");
+
+        Bank::init();
+        Channel::init();
+
+        // Both levels are written on the next selection
+        s_bank = 0xFF;
+        s_channel = 0xFF;
+    }
+
+    /**
+    @brief Select channel
+    @param channel Selected channel (0..getNofChannels()-1)
+    */
+    static void selectChannel(const uint8_t channel)
+    {
+        const uint8_t bank = channel / Channel::getNofChannels();
+        const uint8_t localChannel = channel % Channel::getNofChannels();
+
+        if (localChannel != s_channel)
+        {
+            s_channel = localChannel;
+            Channel::selectChannel(localChannel);
+        }
+
+        if (bank != s_bank)
+        {
+            s_bank = bank;
+            selectBank(bank);
+        }
+    }
+
+    private:
+
+    static void selectBank(const uint8_t bank) __attribute__((always_inline))
+    {
+        if constexpr (requires { Bank::selectLine(bank); })
+        {
+            Bank::selectLine(bank);
+        }
+        else
+        {
+            Bank::selectChannel(bank);
+        }
+    }
+
+    static uint8_t s_bank; // Selected bank, 0xFF if unknown
+    static uint8_t s_channel; // Selected first level channel, 0xFF if unknown
+};
+
+// Static initialization
+template <typename Bank, typename Channel>
+uint8_t AnalogMultiplexerCascade<Bank, Channel>::s_bank = 0xFF;
+
+// Static initialization
+template <typename Bank, typename Channel>
+uint8_t AnalogMultiplexerCascade<Bank, Channel>::s_channel = 0xFF;
+
+#endif
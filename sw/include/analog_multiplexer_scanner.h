@@ -0,0 +1,389 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef ANALOG_MULTIPLEXER_SCANNER_H
+#define ANALOG_MULTIPLEXER_SCANNER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/pgmspace.h>
+
+template <typename T>
+concept DrvADC = requires
+{
+    T::getPrescaler();
+    T::startConversion();
+    T::getResult();
+};
+
+template <typename T>
+concept DrvOneShotTimer = requires(uint16_t a)
+{
+    T::getPrescaler();
+    T::start(a);
+    T::stop();
+};
+
+/**
+@brief Timer placeholder for AnalogMultiplexerScanner: Switch the multiplexer without a timer
+The multiplexer is switched at the start of the interrupt following the last conversion of a channel, and the first conversion after switching is discarded.
+This needs no timer, but takes one extra conversion per channel
+*/
+struct AnalogMultiplexerNoTimer
+{
+    // Prescaler 0 indicates that no timer is available
+    static constexpr uint16_t getPrescaler()
+    {
+        return 0;
+    }
+
+    static void start(const uint16_t)
+    {}
+
+    static void stop()
+    {}
+};
+
+/**
+@brief Settling configuration for AnalogMultiplexerScanner: Same number of settling conversions for all channels
+@tparam t_nofSettlingConversions Number of conversions to be discarded after switching to a channel
+@note Custom settling configurations can be implemented by any class providing a static constexpr method getNofSettlingConversions(uint8_t channel)
+*/
+template <uint8_t t_nofSettlingConversions = 0>
+struct AnalogMultiplexerSettling
+{
+    static constexpr uint8_t getNofSettlingConversions(const uint8_t)
+    {
+        return t_nofSettlingConversions;
+    }
+};
+
+/**
+@brief Scan order for AnalogMultiplexerScanner: All channels in ascending order
+@tparam t_nofChannels Number of channels
+@note Custom scan orders can be implemented by any class providing static methods getNofPositions() (constexpr) and getChannel(uint8_t position)
+*/
+template <uint8_t t_nofChannels>
+struct AnalogMultiplexerSequentialOrder
+{
+    static constexpr uint8_t getNofPositions()
+    {
+        return t_nofChannels;
+    }
+
+    static constexpr uint8_t getChannel(const uint8_t position)
+    {
+        return position;
+    }
+};
+
+/**
+@brief Scan order for AnalogMultiplexerScanner: Gray code order, skipping unused channels
+Consecutive channels differ in one select line only (if no channels are skipped), so each step changes one multiplexer control signal and causes minimal switching glitches.
+The order is calculated at compile time and stored in PROGMEM
+@tparam t_nofChannels Number of channels (1..128)
+@tparam t_unusedChannels Bit mask of channels 0..63 which are not scanned
+*/
+template <uint8_t t_nofChannels, uint64_t t_unusedChannels = 0>
+class AnalogMultiplexerGrayCodeOrder
+{
+    static_assert(t_nofChannels > 0 && t_nofChannels <= 128, "Invalid number of channels");
+
+    public:
+
+    static constexpr uint8_t getNofPositions()
+    {
+        uint8_t nofPositions = 0;
+        for (uint8_t channel = 0; channel < t_nofChannels; ++channel)
+        {
+            nofPositions += isUsed(channel) ? 1 : 0;
+        }
+        return nofPositions;
+    }
+
+    static uint8_t getChannel(const uint8_t position)
+    {
+        static_assert(getNofPositions() > 0, "At least one channel must be used");
+
+        return pgm_read_byte(&s_order.channel[position]);
+    }
+
+    private:
+
+    static constexpr bool isUsed(const uint8_t channel)
+    {
+        return channel >= 64 || !((t_unusedChannels >> channel) & 1);
+    }
+
+    // Table of channels in Gray code order
+    struct Order
+    {
+        constexpr Order() : channel()
+        {
+            // Gray code sequence is generated for the next power of two, channels exceeding t_nofChannels are skipped
+            uint8_t position = 0;
+            for (uint16_t code = 0; code < 256; ++code)
+            {
+                const uint16_t gray = code ^ (code >> 1);
+                if (gray < t_nofChannels && isUsed(gray) && code < getSequenceLength())
+                {
+                    channel[position++] = gray;
+                }
+            }
+        }
+
+        uint8_t channel[t_nofChannels]; // Only the first getNofPositions() entries are used
+    };
+
+    static constexpr uint16_t getSequenceLength()
+    {
+        uint16_t length = 1;
+        while (length < t_nofChannels)
+        {
+            length <<= 1;
+        }
+        return length;
+    }
+
+    static const Order s_order;
+};
+
+// Static initialization
+template <uint8_t t_nofChannels, uint64_t t_unusedChannels>
+const typename AnalogMultiplexerGrayCodeOrder<t_nofChannels, t_unusedChannels>::Order AnalogMultiplexerGrayCodeOrder<t_nofChannels, t_unusedChannels>::s_order PROGMEM;
+
+/**
+@brief Continuous interrupt-driven scan of all channels of an analog multiplexer
+Each conversion is started by onConversionComplete(), which has to be called from the ADC conversion complete interrupt.
+When the last conversion of a channel is started, a one-shot timer is armed to expire after the sample & hold phase. onSampleHoldComplete(), called from the timer compare interrupt, then switches the multiplexer to the next channel.
+So the next channel settles while the ADC is still converting, which adds one conversion time of settling for free, and no interrupt waits.
+The sample & hold phase ends 1.5 ADC clock cycles after the start of a conversion. A single conversion starts with the next rising edge of the ADC clock, so the timer is armed for 2.5 ADC clock cycles.
+With AnalogMultiplexerNoTimer, the multiplexer is switched in onConversionComplete() instead and the first conversion after switching is discarded in addition to the settling conversions.
+Samples are stored in a double buffer: While the scanner fills one buffer, the application reads the previous complete frame from the other one.
+@tparam Mux Multiplexer driver class implementing static methods getNofChannels() and selectChannel(uint8_t), e.g. AnalogMultiplexer
+@tparam ADC ADC driver class implementing static methods getPrescaler() (constexpr, ADC clock prescaler), startConversion() (non-blocking, conversion complete interrupt enabled) and getResult()
+@tparam Timer One-shot timer driver class implementing static methods getPrescaler() (constexpr, timer clock prescaler relative to F_CPU), start(uint16_t ticks) (enable compare interrupt after ticks timer clocks) and stop() (disable compare interrupt), or AnalogMultiplexerNoTimer
+@tparam t_nofSamples Number of samples averaged per channel and frame (power of two, 1..64)
+@tparam Settling Settling configuration, e.g. AnalogMultiplexerSettling or any class implementing static method getNofSettlingConversions(uint8_t channel)
+@tparam ScanOrder Scan order, e.g. AnalogMultiplexerSequentialOrder (default) or AnalogMultiplexerGrayCodeOrder. Samples of channels not contained in the scan order are zero
+*/
+template <typename Mux, DrvADC ADC, DrvOneShotTimer Timer, uint8_t t_nofSamples = 1, typename Settling = AnalogMultiplexerSettling<>, typename ScanOrder = AnalogMultiplexerSequentialOrder<Mux::getNofChannels()>>
+class AnalogMultiplexerScanner
+{
+    static_assert(t_nofSamples > 0 && t_nofSamples <= 64 && (t_nofSamples & (t_nofSamples - 1)) == 0, "Number of samples must be a power of two in the range 1..64");
+
+    public:
+
+    /**
+    @brief Get the number of scanned channels
+    @result Number of channels
+    */
+    static constexpr uint8_t getNofChannels()
+    {
+        return Mux::getNofChannels();
+    }
+
+    /**
+    @brief Start continuous scanning
+    @note Mux and ADC drivers have to be initialized beforehand. The first frame may contain unsettled samples of the first channel
+    */
+    static void start()
+    {
+        s_position = 0;
+        s_conversionIdx = 0;
+        s_sum = 0;
+        s_running = true;
+
+        Mux::selectChannel(ScanOrder::getChannel(0));
+        startConversion(0, 0);
+    }
+
+    /**
+    @brief Stop scanning after the current conversion
+    */
+    static void stop()
+    {
+        s_running = false;
+    }
+
+    /**
+    @brief Get the latest sample of a channel
+    @param channel Channel index (0..getNofChannels()-1)
+    @result Averaged ADC result of the last complete frame
+    */
+    static uint16_t getSample(const uint8_t channel)
+    {
+        return s_samples[s_frontIdx][channel];
+    }
+
+    /**
+    @brief Get the number of completed frames
+    @result Frame counter (wraps around). A changed value indicates new samples
+    */
+    static uint8_t getFrameCount()
+    {
+        return s_frameCount;
+    }
+
+    /**
+    @brief Callback for ADC conversion complete interrupt
+    */
+    static void onConversionComplete() __attribute__((always_inline))
+    {
+        if (!s_running)
+        {
+            return;
+        }
+
+        const uint16_t result = ADC::getResult();
+        const uint8_t position = s_position;
+        const uint8_t conversionIdx = s_conversionIdx;
+        const uint8_t channel = ScanOrder::getChannel(position);
+        const uint8_t nofSettlingConversions = getNofSettlingConversions(channel);
+
+        // Advance to the next conversion
+        uint8_t nextPosition = position;
+        uint8_t nextConversionIdx = conversionIdx + 1;
+        if (nextConversionIdx == nofSettlingConversions + t_nofSamples)
+        {
+            nextPosition = getNextPosition(position);
+            nextConversionIdx = 0;
+
+            // Without timer, the multiplexer is switched before the first conversion of the next channel
+            if constexpr (!isTimed())
+            {
+                Mux::selectChannel(ScanOrder::getChannel(nextPosition));
+            }
+        }
+        s_position = nextPosition;
+        s_conversionIdx = nextConversionIdx;
+
+        // Start the next conversion as early as possible
+        startConversion(nextPosition, nextConversionIdx);
+
+        // Store result
+        if (conversionIdx >= nofSettlingConversions)
+        {
+            s_sum += result;
+        }
+
+        if (nextConversionIdx == 0)
+        {
+            const uint8_t backIdx = s_frontIdx ^ 1;
+            s_samples[backIdx][channel] = s_sum / t_nofSamples;
+            s_sum = 0;
+
+            // Frame is complete, so the buffers are swapped
+            if (nextPosition == 0)
+            {
+                s_frontIdx = backIdx;
+                s_frameCount = s_frameCount + 1;
+            }
+        }
+    }
+
+    /**
+    @brief Callback for the timer compare interrupt: Sample & hold of the last conversion of a channel is over
+    */
+    static void onSampleHoldComplete() __attribute__((always_inline))
+    {
+        Timer::stop();
+
+        // The conversion in progress is the last one of its channel
+        Mux::selectChannel(ScanOrder::getChannel(getNextPosition(s_position)));
+    }
+
+    private:
+
+    static constexpr bool isTimed()
+    {
+        return Timer::getPrescaler() != 0;
+    }
+
+    // 2.5 ADC clock cycles in timer clocks, rounded up
+    static constexpr uint32_t getSampleHoldTicks()
+    {
+        return (5UL * ADC::getPrescaler() + 2UL * Timer::getPrescaler() - 1) / (2UL * Timer::getPrescaler());
+    }
+
+    static constexpr uint8_t getNextPosition(const uint8_t position)
+    {
+        return (position + 1 < ScanOrder::getNofPositions()) ? (position + 1) : 0;
+    }
+
+    // Number of discarded conversions of a channel. Without timer, the first conversion after switching is discarded as well
+    static constexpr uint8_t getNofSettlingConversions(const uint8_t channel)
+    {
+        return Settling::getNofSettlingConversions(channel) + (isTimed() ? 0 : 1);
+    }
+
+    // Start a conversion. If it is the last one of its channel, the timer switches the multiplexer to the next channel after sample & hold
+    static void startConversion(const uint8_t position, const uint8_t conversionIdx) __attribute__((always_inline))
+    {
+        ADC::startConversion();
+
+        if constexpr (isTimed())
+        {
+            static_assert(getSampleHoldTicks() <= 0xFFFF, "Timer prescaler too small for the sample & hold time");
+
+            if (conversionIdx + 1 == getNofSettlingConversions(ScanOrder::getChannel(position)) + t_nofSamples)
+            {
+                Timer::start(getSampleHoldTicks());
+            }
+        }
+    }
+
+    typedef uint16_t Frame[Mux::getNofChannels()];
+
+    static Frame s_samples[2];
+    static volatile uint8_t s_frontIdx; // Buffer of last complete frame
+    static volatile uint8_t s_frameCount;
+    static volatile bool s_running;
+    static uint8_t s_position; // Scan position of the conversion in progress
+    static uint8_t s_conversionIdx; // Index of the conversion in progress within its channel
+    static uint16_t s_sum;
+};
+
+// Static initialization
+template <typename Mux, DrvADC ADC, DrvOneShotTimer Timer, uint8_t t_nofSamples, typename Settling, typename ScanOrder>
+typename AnalogMultiplexerScanner<Mux, ADC, Timer, t_nofSamples, Settling, ScanOrder>::Frame AnalogMultiplexerScanner<Mux, ADC, Timer, t_nofSamples, Settling, ScanOrder>::s_samples[2];
+
+// Static initialization
+template <typename Mux, DrvADC ADC, DrvOneShotTimer Timer, uint8_t t_nofSamples, typename Settling, typename ScanOrder>
+volatile uint8_t AnalogMultiplexerScanner<Mux, ADC, Timer, t_nofSamples, Settling, ScanOrder>::s_frontIdx = 0;
+
+// Static initialization
+template <typename Mux, DrvADC ADC, DrvOneShotTimer Timer, uint8_t t_nofSamples, typename Settling, typename ScanOrder>
+volatile uint8_t AnalogMultiplexerScanner<Mux, ADC, Timer, t_nofSamples, Settling, ScanOrder>::s_frameCount = 0;
+
+// Static initialization
+template <typename Mux, DrvADC ADC, DrvOneShotTimer Timer, uint8_t t_nofSamples, typename Settling, typename ScanOrder>
+volatile bool AnalogMultiplexerScanner<Mux, ADC, Timer, t_nofSamples, Settling, ScanOrder>::s_running = false;
+
+// Static initialization
+template <typename Mux, DrvADC ADC, DrvOneShotTimer Timer, uint8_t t_nofSamples, typename Settling, typename ScanOrder>
+uint8_t AnalogMultiplexerScanner<Mux, ADC, Timer, t_nofSamples, Settling, ScanOrder>::s_position = 0;
+
+// Static initialization
+template <typename Mux, DrvADC ADC, DrvOneShotTimer Timer, uint8_t t_nofSamples, typename Settling, typename ScanOrder>
+uint8_t AnalogMultiplexerScanner<Mux, ADC, Timer, t_nofSamples, Settling, ScanOrder>::s_conversionIdx = 0;
+
+// Static initialization
+template <typename Mux, DrvADC ADC, DrvOneShotTimer Timer, uint8_t t_nofSamples, typename Settling, typename ScanOrder>
+uint16_t AnalogMultiplexerScanner<Mux, ADC, Timer, t_nofSamples, Settling, ScanOrder>::s_sum = 0;
+
+#endif
@@ -0,0 +1,262 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATRIX_SCANNER_H
+#define MATRIX_SCANNER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ring_buffer.h"
+
+/// @brief Key change event of MatrixScanner
+struct MatrixScannerEvent
+{
+    uint8_t key; // Key index, i.e. row * number of columns + column
+    bool pressed; // true if the key has been pressed, false if it has been released
+};
+
+/**
+@brief Incremental scanner for key/button matrices
+Each call of tick() samples the columns of the active row, debounces them and selects the next row, so the execution time per tick is short and constant.
+The row is selected one tick before it is sampled, which gives the matrix a full tick period to settle.
+Keys are debounced by 2 bit vertical counters: A key changes its state after 4 consecutive identical samples, i.e. after 4 * rows ticks.
+Changes of the debounced state are pushed as MatrixScannerEvent into a ring buffer, which can be drained e.g. by the main loop.
+@tparam Rows Row driver class implementing static methods nofLines(), init() and selectLine(uint8_t), e.g. LineDecoder
+@tparam Columns Column input class, either a LineEncoder or any GPIOPort/GPIOSubPort driver class implementing static methods getNofPins() and read()
+@tparam t_activeLow true if a pressed key reads as low on a column port (pull-up resistors). Ignored for LineEncoder
+@tparam t_capacity Number of events to be stored (power of two, 1..128)
+@note LineEncoder (e.g. 74HC148) only detects one key per row. Its input 0 has to be tied to active level, so line 0 means "no key pressed" and keys are connected to lines 1..N-1
+*/
+template <typename Rows, typename Columns, bool t_activeLow = true, uint8_t t_capacity = 16>
+class MatrixScanner
+{
+    public:
+
+    /// @brief Event data type
+    typedef MatrixScannerEvent Event;
+
+    /**
+    @brief Get the number of rows
+    @result Number of rows
+    */
+    static constexpr uint8_t getNofRows()
+    {
+        return Rows::nofLines();
+    }
+
+    /**
+    @brief Get the number of columns
+    @result Number of columns
+    */
+    static constexpr uint8_t getNofColumns()
+    {
+        if constexpr (isEncoder())
+        {
+            return Columns::getNofLines();
+        }
+        else
+        {
+            return Columns::getNofPins();
+        }
+    }
+
+    /**
+    @brief Get the number of keys
+    @result Number of keys
+    */
+    static constexpr uint8_t getNofKeys()
+    {
+        return getNofRows() * getNofColumns();
+    }
+
+    /**
+    @brief Initialization
+    All keys are released. Row and column drivers are initialized, if they provide an init() method
+    */
+    static void init()
+    {
+        static_assert(getNofColumns() <= 8, "Up to 8 columns are supported");
+
+        Rows::init();
+        if constexpr (requires { Columns::init(); })
+        {
+            Columns::init();
+        }
+
+        for (uint8_t row = 0; row < getNofRows(); ++row)
+        {
+            s_state[row] = 0;
+            s_count0[row] = 0xFF;
+            s_count1[row] = 0xFF;
+        }
+
+        s_row = 0;
+        Rows::selectLine(0);
+    }
+
+    /**
+    @brief Scan one row, has to be called periodically, e.g. every 1 ms from a timer ISR
+    */
+    static void tick()
+    {
+        const uint8_t row = s_row;
+
+        // Vertical counters count consecutive samples differing from the debounced state, and are reset otherwise
+        const uint8_t delta = readColumns() ^ s_state[row];
+        const uint8_t count0 = ~(s_count0[row] & delta);
+        const uint8_t count1 = count0 ^ (s_count1[row] & delta);
+        s_count0[row] = count0;
+        s_count1[row] = count1;
+
+        // Keys whose counters have rolled over change their state
+        const uint8_t changed = delta & count0 & count1;
+
+        // Next row settles until the next tick
+        const uint8_t nextRow = (row + 1 < getNofRows()) ? (row + 1) : 0;
+        s_row = nextRow;
+        Rows::selectLine(nextRow);
+
+        if (changed != 0)
+        {
+            const uint8_t state = s_state[row] ^ changed;
+            s_state[row] = state;
+            report(row, changed, state);
+        }
+    }
+
+    /**
+    @brief Get the debounced state of a key
+    @param key Key index (0..getNofKeys()-1)
+    @result true if the key is pressed
+    */
+    static bool isPressed(const uint8_t key)
+    {
+        return s_state[key / getNofColumns()] & _BV(key % getNofColumns());
+    }
+
+    /**
+    @brief Get the debounced state of a row
+    @param row Row index (0..getNofRows()-1)
+    @result Bit mask of pressed keys, bit n corresponds to column n
+    */
+    static uint8_t getRow(const uint8_t row)
+    {
+        return s_state[row];
+    }
+
+    /**
+    @brief Fetch the oldest event
+    @param event Event to be filled
+    @result false if there is no pending event
+    */
+    static bool pop(Event & event)
+    {
+        if (s_events.empty())
+        {
+            return false;
+        }
+
+        event = s_events.front();
+        s_events.pop();
+        return true;
+    }
+
+    /**
+    @brief Check if events have been dropped since the last call
+    @result true if events have been dropped
+    */
+    static bool hasOverflowed()
+    {
+        const bool overflow = s_overflow;
+        s_overflow = false;
+        return overflow;
+    }
+
+    private:
+
+    static constexpr bool isEncoder()
+    {
+        return requires { Columns::getLine(); };
+    }
+
+    // Read the columns of the selected row as bit mask of pressed keys
+    static uint8_t readColumns() __attribute__((always_inline))
+    {
+        if constexpr (isEncoder())
+        {
+            // Line 0 is tied to active level and means "no key pressed"
+            const uint8_t line = Columns::getLine();
+            return (line != 0) ? _BV(line) : 0;
+        }
+        else
+        {
+            constexpr uint8_t mask = (getNofColumns() < 8) ? (_BV(getNofColumns()) - 1) : 0xFF;
+            const uint8_t value = Columns::read();
+            return (t_activeLow ? ~value : value) & mask;
+        }
+    }
+
+    static void report(const uint8_t row, uint8_t changed, const uint8_t state)
+    {
+        const uint8_t firstKey = row * getNofColumns();
+        for (uint8_t column = 0; changed != 0; ++column, changed >>= 1)
+        {
+            if (changed & 1)
+            {
+                if (!s_events.push(Event{static_cast<uint8_t>(firstKey + column), static_cast<bool>(state & _BV(column))}))
+                {
+                    s_overflow = true;
+                }
+            }
+        }
+    }
+
+    typedef uint8_t RowData[getNofRows()];
+
+    static RowData s_state; // Debounced state, bit n of each row corresponds to column n
+    static RowData s_count0; // Vertical counter, bit 0
+    static RowData s_count1; // Vertical counter, bit 1
+    static uint8_t s_row; // Selected row
+    static RingBuffer<Event, t_capacity> s_events;
+    static volatile bool s_overflow;
+};
+
+// Static initialization
+template <typename Rows, typename Columns, bool t_activeLow, uint8_t t_capacity>
+typename MatrixScanner<Rows, Columns, t_activeLow, t_capacity>::RowData MatrixScanner<Rows, Columns, t_activeLow, t_capacity>::s_state;
+
+// Static initialization
+template <typename Rows, typename Columns, bool t_activeLow, uint8_t t_capacity>
+typename MatrixScanner<Rows, Columns, t_activeLow, t_capacity>::RowData MatrixScanner<Rows, Columns, t_activeLow, t_capacity>::s_count0;
+
+// Static initialization
+template <typename Rows, typename Columns, bool t_activeLow, uint8_t t_capacity>
+typename MatrixScanner<Rows, Columns, t_activeLow, t_capacity>::RowData MatrixScanner<Rows, Columns, t_activeLow, t_capacity>::s_count1;
+
+// Static initialization
+template <typename Rows, typename Columns, bool t_activeLow, uint8_t t_capacity>
+uint8_t MatrixScanner<Rows, Columns, t_activeLow, t_capacity>::s_row = 0;
+
+// Static initialization
+template <typename Rows, typename Columns, bool t_activeLow, uint8_t t_capacity>
+RingBuffer<MatrixScannerEvent, t_capacity> MatrixScanner<Rows, Columns, t_activeLow, t_capacity>::s_events;
+
+// Static initialization
+template <typename Rows, typename Columns, bool t_activeLow, uint8_t t_capacity>
+volatile bool MatrixScanner<Rows, Columns, t_activeLow, t_capacity>::s_overflow = false;
+
+#endif
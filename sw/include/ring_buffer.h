@@ -0,0 +1,161 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+@brief Fixed-capacity single-producer/single-consumer ring buffer
+The producer (e.g. main loop) calls back()/commit() or push(), the consumer (e.g. an ISR) calls front()/pop() or vice versa.
+Read and write counters are 8 bit and only modified by one side each, so no locking is needed on AVR.
+The element data is not volatile, so commit() and pop() use a compiler barrier to keep element accesses from being reordered across the counter updates.
+@tparam T Element type
+@tparam t_capacity Number of elements (power of two, 1..128)
+*/
+template <typename T, uint8_t t_capacity>
+class RingBuffer
+{
+    static_assert(t_capacity > 0 && t_capacity <= 128 && (t_capacity & (t_capacity - 1)) == 0, "Capacity must be a power of two in the range 1..128");
+
+    public:
+
+    /**
+    @brief Get the capacity of the ring buffer
+    @result Maximum number of elements
+    */
+    static constexpr uint8_t capacity()
+    {
+        return t_capacity;
+    }
+
+    /**
+    @brief Get the number of stored elements
+    @result Number of stored elements
+    */
+    uint8_t size() const
+    {
+        // Free-running counters, unsigned overflow is intended
+        return static_cast<uint8_t>(m_writeCount - m_readCount);
+    }
+
+    /**
+    @brief Get the number of free elements
+    @result Number of free elements
+    */
+    uint8_t available() const
+    {
+        return t_capacity - size();
+    }
+
+    /**
+    @brief Check if ring buffer is empty
+    @result true if no element is stored
+    */
+    bool empty() const
+    {
+        return m_writeCount == m_readCount;
+    }
+
+    /**
+    @brief Check if ring buffer is full
+    @result true if no element can be pushed
+    */
+    bool full() const
+    {
+        return size() == t_capacity;
+    }
+
+    /**
+    @brief Access the oldest element (consumer side)
+    @result Reference to the oldest element
+    @note Ring buffer must not be empty
+    */
+    T & front()
+    {
+        return m_data[m_readCount & (t_capacity - 1)];
+    }
+
+    /**
+    @brief Remove the oldest element (consumer side)
+    @note Ring buffer must not be empty
+    */
+    void pop()
+    {
+        // Finish reading the element before releasing it to the producer
+        __asm__ __volatile__("" ::: "memory");
+        m_readCount = m_readCount + 1;
+    }
+
+    /**
+    @brief Access the next free element (producer side)
+    The element can be filled in place and is committed by commit()
+    @param offset Offset of the free element relative to the next free element (0..available()-1)
+    @result Reference to the free element
+    @note Ring buffer must not be full
+    */
+    T & back(const uint8_t offset = 0)
+    {
+        return m_data[(m_writeCount + offset) & (t_capacity - 1)];
+    }
+
+    /**
+    @brief Commit elements filled in place via back() (producer side)
+    @param nofElements Number of elements to be committed
+    */
+    void commit(const uint8_t nofElements = 1)
+    {
+        // Finish writing the elements before publishing them to the consumer
+        __asm__ __volatile__("" ::: "memory");
+        m_writeCount = m_writeCount + nofElements;
+    }
+
+    /**
+    @brief Copy an element to the ring buffer (producer side)
+    @param element Element to be stored
+    @result false if the ring buffer is full and the element has been discarded
+    */
+    bool push(const T & element)
+    {
+        if (full())
+        {
+            return false;
+        }
+
+        back() = element;
+        commit();
+        return true;
+    }
+
+    /**
+    @brief Remove all elements (consumer side)
+    */
+    void clear()
+    {
+        m_readCount = m_writeCount;
+    }
+
+    private:
+
+    T m_data[t_capacity];
+    volatile uint8_t m_writeCount = 0;
+    volatile uint8_t m_readCount = 0;
+};
+
+#endif
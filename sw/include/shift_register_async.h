@@ -0,0 +1,158 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SHIFT_REGISTER_ASYNC_H
+#define SHIFT_REGISTER_ASYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+template <typename T>
+concept DrvSPIMasterAsync = requires(uint8_t a)
+{
+    T::startTransfer(a);
+};
+
+/**
+@brief Interrupt-driven driver for shift register (e.g. daisy-chained 74HC595) connected to SPI master
+put() only starts the transfer of the first byte. All further bytes are transferred by onTransferComplete(), which has to be called from the SPI transfer complete interrupt (or the USART data register empty interrupt in SPI mode).
+The SS pin is released after the last byte, which latches the data to the outputs. So the CPU does not wait for the SPI at all.
+@tparam SPIMaster SPI master driver class implementing a static method startTransfer(uint8_t), which starts the transfer of one byte without waiting for its completion
+@tparam SSPin Pin driver class implementing static methods high() and low()
+@tparam t_nofBytes Number of bytes
+@note The SPI bus must not be used by other devices until isDone() returns true
+*/
+template <DrvSPIMasterAsync SPIMaster, typename SSPin, uint8_t t_nofBytes = 1>
+class ShiftRegisterAsync
+{
+    static_assert(t_nofBytes > 0, "At least one byte is needed");
+
+    public:
+
+    /**
+    @brief Get the width of the shift register
+    @result Number of bytes
+    */
+    static constexpr uint8_t getNofBytes()
+    {
+        return t_nofBytes;
+    }
+
+    /**
+    @brief Start the transfer of data to shift register
+    @param data Data to be sent to shift register. The data is not copied, so the buffer has to be valid until isDone() returns true
+    @result false if the previous transfer is still in progress. In this case, nothing will be sent
+    @note Make sure data has sufficient length of t_nofBytes bytes!
+    */
+    static bool put(const uint8_t * const data)
+    {
+        if (!isDone())
+        {
+            return false;
+        }
+
+        // Busy flag is set before the first byte is started, so a fast interrupt is never missed
+        s_busy = true;
+        s_data = data + 1;
+        s_remaining = t_nofBytes - 1;
+
+        // Enable shift register (active low)
+        SSPin::low();
+
+        // Transmit first byte. All further bytes are transmitted by onTransferComplete()
+        SPIMaster::startTransfer(*data);
+
+        return true;
+    }
+
+    /**
+    @brief Check if the last transfer has been finished
+    @result true if the data has been latched to the outputs
+    */
+    static bool isDone()
+    {
+        return !s_busy;
+    }
+
+    /**
+    @brief Wait until the last transfer has been finished
+    */
+    static void flush()
+    {
+        while (!isDone());
+    }
+
+    /**
+    @brief Put data to shift register and wait for completion
+    @param data Data to be sent to shift register
+    @note Make sure data has sufficient length of t_nofBytes bytes!
+    */
+    static void putBlocking(const uint8_t * const data)
+    {
+        flush();
+        put(data);
+        flush();
+    }
+
+    /**
+    @brief Callback for SPI transfer complete interrupt
+    @note It is safe to call this method if no transfer is in progress, so the SPI interrupt can be shared with other devices
+    */
+    static void onTransferComplete() __attribute__((always_inline))
+    {
+        if (!s_busy)
+        {
+            return;
+        }
+
+        // Local copies avoid repeated access to volatile members
+        const uint8_t remaining = s_remaining;
+        if (remaining > 0)
+        {
+            const uint8_t * const data = s_data;
+            s_remaining = remaining - 1;
+            s_data = data + 1;
+            SPIMaster::startTransfer(*data);
+        }
+        else
+        {
+            // Disable shift register (active low). This latches the data to the outputs
+            SSPin::high();
+            s_busy = false;
+        }
+    }
+
+    private:
+
+    static const uint8_t * volatile s_data; // Next byte to be transferred
+    static volatile uint8_t s_remaining; // Number of bytes after the current one
+    static volatile bool s_busy;
+};
+
+// Static initialization
+template <DrvSPIMasterAsync SPIMaster, typename SSPin, uint8_t t_nofBytes>
+const uint8_t * volatile ShiftRegisterAsync<SPIMaster, SSPin, t_nofBytes>::s_data = nullptr;
+
+// Static initialization
+template <DrvSPIMasterAsync SPIMaster, typename SSPin, uint8_t t_nofBytes>
+volatile uint8_t ShiftRegisterAsync<SPIMaster, SSPin, t_nofBytes>::s_remaining = 0;
+
+// Static initialization
+template <DrvSPIMasterAsync SPIMaster, typename SSPin, uint8_t t_nofBytes>
+volatile bool ShiftRegisterAsync<SPIMaster, SSPin, t_nofBytes>::s_busy = false;
+
+#endif
@@ -0,0 +1,203 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SHIFT_REGISTER_IMAGE_H
+#define SHIFT_REGISTER_IMAGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+@brief Output image for shift register chains
+Outputs are modified in a RAM image. update() only transfers the image if it has been modified since the last transfer, so it can be called periodically (e.g. every 1 ms from a timer ISR) at almost no cost.
+The image is double-buffered: update() copies it to a transmit buffer, which is shifted out while the image can already be modified again. So a transfer in progress (e.g. by ShiftRegisterAsync) never latches a partially modified image.
+Output index n refers to bit (n % 8) of byte (n / 8), with bytes in the order passed to put(), i.e. byte 0 is shifted out first.
+@tparam Device Shift register driver class, i.e. a specialization of ShiftRegister, ShiftRegisterAsync or _74HC595
+@note Modifications and update() may be called from different contexts. The modified flag is cleared before the transfer, so a concurrent modification is never lost
+*/
+template <typename Device>
+class ShiftRegisterImage
+{
+    public:
+
+    /**
+    @brief Get the width of the shift register chain
+    @result Number of bytes
+    */
+    static constexpr uint8_t getNofBytes()
+    {
+        if constexpr (requires { Device::getNofDevices(); })
+        {
+            return Device::getNofDevices();
+        }
+        else
+        {
+            return Device::getNofBytes();
+        }
+    }
+
+    /**
+    @brief Get the number of outputs
+    @result Number of outputs
+    */
+    static constexpr uint16_t getNofOutputs()
+    {
+        return getNofBytes() * 8;
+    }
+
+    /**
+    @brief Set an output
+    @param idx Output index (0..getNofOutputs()-1)
+    */
+    static void setBit(const uint16_t idx) __attribute__((always_inline))
+    {
+        writeMask(idx >> 3, _BV(idx & 0b111), 0xFF);
+    }
+
+    /**
+    @brief Clear an output
+    @param idx Output index (0..getNofOutputs()-1)
+    */
+    static void clearBit(const uint16_t idx) __attribute__((always_inline))
+    {
+        writeMask(idx >> 3, _BV(idx & 0b111), 0x00);
+    }
+
+    /**
+    @brief Write an output
+    @param idx Output index (0..getNofOutputs()-1)
+    @param value Output value
+    */
+    static void writeBit(const uint16_t idx, const bool value) __attribute__((always_inline))
+    {
+        writeMask(idx >> 3, _BV(idx & 0b111), value ? 0xFF : 0x00);
+    }
+
+    /**
+    @brief Read an output from the image
+    @param idx Output index (0..getNofOutputs()-1)
+    @result Output value
+    */
+    static bool readBit(const uint16_t idx) __attribute__((always_inline))
+    {
+        return s_image[idx >> 3] & _BV(idx & 0b111);
+    }
+
+    /**
+    @brief Write selected outputs of one byte
+    @param byteIdx Byte index (0..getNofBytes()-1)
+    @param mask Bit mask of outputs to be written
+    @param value Output values. Bits not set in mask are ignored
+    */
+    static void writeMask(const uint8_t byteIdx, const uint8_t mask, const uint8_t value)
+    {
+        const uint8_t image = (s_image[byteIdx] & ~mask) | (value & mask);
+        if (image != s_image[byteIdx])
+        {
+            s_image[byteIdx] = image;
+            s_modified = true;
+        }
+    }
+
+    /**
+    @brief Write all outputs of one byte
+    @param byteIdx Byte index (0..getNofBytes()-1)
+    @param value Output values
+    */
+    static void write(const uint8_t byteIdx, const uint8_t value)
+    {
+        writeMask(byteIdx, 0xFF, value);
+    }
+
+    /**
+    @brief Read all outputs of one byte from the image
+    @param byteIdx Byte index (0..getNofBytes()-1)
+    @result Output values
+    */
+    static uint8_t read(const uint8_t byteIdx)
+    {
+        return s_image[byteIdx];
+    }
+
+    /**
+    @brief Check if the image has been modified since the last transfer
+    @result true if update() would transfer the image
+    */
+    static bool isModified()
+    {
+        return s_modified;
+    }
+
+    /**
+    @brief Transfer the image to the shift register chain if it has been modified
+    @result true if the image has been transferred (or its transfer has been started, for ShiftRegisterAsync)
+    */
+    static bool update()
+    {
+        if (!s_modified)
+        {
+            return false;
+        }
+
+        // Asynchronous devices cannot start a new transfer while the previous one is in progress
+        if constexpr (requires { Device::isDone(); })
+        {
+            if (!Device::isDone())
+            {
+                return false;
+            }
+        }
+
+        s_modified = false;
+        for (uint8_t byteIdx = 0; byteIdx < getNofBytes(); ++byteIdx)
+        {
+            s_transmit[byteIdx] = s_image[byteIdx];
+        }
+        Device::put(s_transmit);
+        return true;
+    }
+
+    /**
+    @brief Force a transfer of the image on the next update(), e.g. after power-on
+    */
+    static void invalidate()
+    {
+        s_modified = true;
+    }
+
+    private:
+
+    typedef uint8_t Image[getNofBytes()];
+
+    static Image s_image;
+    static Image s_transmit; // Copy of the image being transferred
+    static volatile bool s_modified;
+};
+
+// Static initialization
+template <typename Device>
+typename ShiftRegisterImage<Device>::Image ShiftRegisterImage<Device>::s_image;
+
+// Static initialization
+template <typename Device>
+typename ShiftRegisterImage<Device>::Image ShiftRegisterImage<Device>::s_transmit;
+
+// Static initialization
+template <typename Device>
+volatile bool ShiftRegisterImage<Device>::s_modified = true;
+
+#endif
@@ -0,0 +1,239 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SPI_BUS_H
+#define SPI_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/io.h>
+#include "ring_buffer.h"
+
+/**
+@brief SPI clock and mode configuration for AVR hardware SPI
+Settings are encoded in one byte: Bits 3:0 hold CPOL, CPHA, SPR1 and SPR0 at their SPCR positions, bit 7 holds SPI2X.
+select() only writes the SPI registers if the settings actually change.
+*/
+class AVRSPIConfig
+{
+    public:
+
+    /**
+    @brief Get the settings for the fastest SPI clock not exceeding a device limit
+    @param maxClock Maximum SPI clock of device in Hz, e.g. _25LC512_MAX_SPI_CLOCK
+    @param mode SPI mode (0..3)
+    @result Encoded settings
+    @note If even F_CPU / 128 exceeds maxClock, the slowest clock is used
+    */
+    static constexpr uint8_t getSettings(const uint32_t maxClock, const uint8_t mode = 0)
+    {
+        // Divider sequence 2, 4, ..., 128 and corresponding SPR1:0 (bits 1:0) and SPI2X (bit 7)
+        constexpr uint8_t encoding[] = {0x80, 0x00, 0x81, 0x01, 0x82, 0x83, 0x03};
+        uint8_t idx = 0;
+        while (idx < 6 && (F_CPU >> (idx + 1)) > maxClock)
+        {
+            ++idx;
+        }
+        return encoding[idx] | ((mode & 0b11) << CPHA);
+    }
+
+    /**
+    @brief Get the settings for the fastest SPI clock supported by a device
+    @tparam Device Driver class implementing a static constexpr method getMaxSPIClock(), e.g. _25LC512
+    @param mode SPI mode (0..3)
+    @result Encoded settings
+    */
+    template <typename Device>
+    static constexpr uint8_t getSettings(const uint8_t mode = 0)
+    {
+        return getSettings(Device::getMaxSPIClock(), mode);
+    }
+
+    /**
+    @brief Apply settings, if they differ from the current ones
+    @param settings Encoded settings, see getSettings()
+    */
+    static void select(const uint8_t settings) __attribute__((always_inline))
+    {
+        if (settings != s_settings)
+        {
+            s_settings = settings;
+            SPCR = (SPCR & ~(_BV(CPOL) | _BV(CPHA) | _BV(SPR1) | _BV(SPR0))) | (settings & 0x0F);
+            SPSR = (settings & 0x80) ? _BV(SPI2X) : 0;
+        }
+    }
+
+    /**
+    @brief Force a register update on the next select(), e.g. after the SPI has been reconfigured by other code
+    */
+    static void invalidate()
+    {
+        s_settings = 0xFF;
+    }
+
+    private:
+
+    static volatile uint8_t s_settings; // Current settings, 0xFF if unknown
+};
+
+// Static initialization. AVRSPIConfig is not a template, so the definition is inline to allow inclusion by multiple translation units
+inline volatile uint8_t AVRSPIConfig::s_settings = 0xFF;
+
+/**
+@brief Chip select pin which switches the SPI clock and mode of its device
+Drivers call low() in the prologue of each transfer, so the SPI is reconfigured right before the device is selected. As Config::select() only writes the registers on changes, consecutive transfers to one device cost a single comparison.
+@tparam SSPin Pin driver class implementing static methods high() and low()
+@tparam t_maxClock Maximum SPI clock of the device in Hz, e.g. _25LC512_MAX_SPI_CLOCK
+@tparam t_mode SPI mode (0..3)
+@tparam Config SPI configuration class, e.g. AVRSPIConfig
+@note Usage: _25LC512<SPIMaster, SPIDevicePin<SSPin, _25LC512_MAX_SPI_CLOCK>>. All other methods of SSPin are inherited
+*/
+template <typename SSPin, uint32_t t_maxClock, uint8_t t_mode = 0, typename Config = AVRSPIConfig>
+class SPIDevicePin : public SSPin
+{
+    public:
+
+    /// @brief Switch SPI settings and select device (active low)
+    static void low() __attribute__((always_inline))
+    {
+        // Settings are calculated at compile time
+        constexpr uint8_t settings = Config::getSettings(t_maxClock, t_mode);
+        Config::select(settings);
+        SSPin::low();
+    }
+
+    /// @brief Deselect device (active low)
+    static void high() __attribute__((always_inline))
+    {
+        SSPin::high();
+    }
+};
+
+struct SPIBusTransaction;
+
+/// @brief Step function of SPIBusTransaction. Executes one bus access (one or more complete SS cycles) and returns true if further steps are pending
+typedef bool (*SPIBusStep)(SPIBusTransaction & transaction);
+
+/**
+@brief Transaction descriptor for SPIBus
+The descriptor is owned by the caller and must stay valid until done is set.
+Long transfers should be split into several steps, e.g. one EEPROM page per step, so transactions with higher priority can be executed in between.
+*/
+struct SPIBusTransaction
+{
+    SPIBusStep step; // Step function, usually calls driver methods like _25LC512::write()
+    uint8_t settings; // SPI clock and mode of the device, see AVRSPIConfig::getSettings()
+    void * context; // User data, e.g. source buffer
+    uint16_t progress; // Number of completed steps, maintained by SPIBus
+    volatile bool done; // Set by SPIBus after the last step
+};
+
+/**
+@brief Priority-based scheduler for devices sharing one SPI bus
+Transactions are submitted to one queue per priority level. run() executes one step of the oldest transaction of the highest priority level.
+A transaction submitted while a lower priority transaction is in progress is executed at the next step boundary, so e.g. an expander interrupt read preempts a long EEPROM write at a page boundary.
+The SPI clock and mode are switched per transaction, so each device runs at its maximum clock.
+@tparam Config SPI configuration class implementing a static method select(uint8_t), e.g. AVRSPIConfig
+@tparam t_nofPriorities Number of priority levels. Level 0 has the highest priority
+@tparam t_capacity Number of pending transactions per priority level (power of two, 1..128)
+@note Each priority level must only be submitted to from one context, e.g. level 0 from interrupts and level 1 from the main loop. Devices must not be accessed outside of transactions while the scheduler is in use
+*/
+template <typename Config = AVRSPIConfig, uint8_t t_nofPriorities = 2, uint8_t t_capacity = 8>
+class SPIBus
+{
+    static_assert(t_nofPriorities > 0, "At least one priority level is needed");
+
+    public:
+
+    /**
+    @brief Submit a transaction
+    @param transaction Transaction descriptor, has to be valid until done is set
+    @param priority Priority level (0..t_nofPriorities-1), 0 is the highest priority
+    @result false if the queue of the priority level is full. In this case, the transaction is not executed
+    */
+    static bool submit(SPIBusTransaction & transaction, const uint8_t priority)
+    {
+        transaction.done = false;
+        transaction.progress = 0;
+        return s_queues[priority].push(&transaction);
+    }
+
+    /**
+    @brief Execute one step of the pending transaction with the highest priority
+    Has to be called repeatedly, e.g. from the main loop
+    @result false if no transaction is pending
+    */
+    static bool run()
+    {
+        for (uint8_t priority = 0; priority < t_nofPriorities; ++priority)
+        {
+            RingBuffer<SPIBusTransaction *, t_capacity> & queue = s_queues[priority];
+            if (queue.empty())
+            {
+                continue;
+            }
+
+            SPIBusTransaction & transaction = *queue.front();
+            Config::select(transaction.settings);
+
+            const bool pending = transaction.step(transaction);
+            transaction.progress = transaction.progress + 1;
+
+            if (!pending)
+            {
+                queue.pop();
+                transaction.done = true;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    /**
+    @brief Execute all pending transactions
+    */
+    static void flush()
+    {
+        while (run());
+    }
+
+    /**
+    @brief Check if no transaction is pending
+    @result true if all queues are empty
+    */
+    static bool isIdle()
+    {
+        for (uint8_t priority = 0; priority < t_nofPriorities; ++priority)
+        {
+            if (!s_queues[priority].empty())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    private:
+
+    static RingBuffer<SPIBusTransaction *, t_capacity> s_queues[t_nofPriorities];
+};
+
+// Static initialization
+template <typename Config, uint8_t t_nofPriorities, uint8_t t_capacity>
+RingBuffer<SPIBusTransaction *, t_capacity> SPIBus<Config, t_nofPriorities, t_capacity>::s_queues[t_nofPriorities];
+
+#endif
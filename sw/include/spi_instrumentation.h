@@ -0,0 +1,301 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SPI_INSTRUMENTATION_H
+#define SPI_INSTRUMENTATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "HD44780_stream.h"
+
+/**
+@brief Statistics policy for SPIInstrumentedPin and SPIInstrumentedMaster: Instrumentation disabled
+All methods are empty and inlined, so instrumented drivers compile to the same code as plain ones
+*/
+struct SPINoStatistics
+{
+    static void begin() __attribute__((always_inline)) {}
+    static void end() __attribute__((always_inline)) {}
+    static void addBytes(const uint16_t) __attribute__((always_inline)) {}
+};
+
+/**
+@brief Statistics policy for SPIInstrumentedPin and SPIInstrumentedMaster: Transaction counters and duration histogram of one device
+A transaction is one SS cycle. Its duration is measured from before SS low to after SS high.
+Durations are sorted into logarithmic buckets: Bucket n counts transactions with a duration of 2^n..2^(n+1)-1 timer ticks, the last bucket also counts all longer ones.
+@tparam Timer Class implementing a static method now() returning a free-running 16 bit time stamp, e.g. a timer counter clocked by F_CPU for cycle-accurate durations
+@tparam t_deviceId Arbitrary number to get separate statistics for each device
+@tparam t_nofBuckets Number of histogram buckets (1..16)
+@note Transactions of one device must not interrupt each other
+*/
+template <typename Timer, uint8_t t_deviceId = 0, uint8_t t_nofBuckets = 8>
+class SPIStatistics
+{
+    static_assert(t_nofBuckets > 0 && t_nofBuckets <= 16, "Number of buckets must be in the range 1..16");
+
+    public:
+
+    /// @brief Transaction prologue, called before SS low
+    static void begin() __attribute__((always_inline))
+    {
+        s_start = Timer::now();
+    }
+
+    /// @brief Transaction epilogue, called after SS high
+    static void end()
+    {
+        // Unsigned overflow is intended
+        const uint16_t duration = static_cast<uint16_t>(Timer::now() - s_start);
+
+        ++s_nofTransactions;
+        s_nofTicks += duration;
+        if (duration > s_maxTicks)
+        {
+            s_maxTicks = duration;
+        }
+
+        uint8_t bucket = 0;
+        for (uint16_t limit = duration >> 1; limit != 0 && bucket < t_nofBuckets - 1; limit >>= 1)
+        {
+            ++bucket;
+        }
+        ++s_histogram[bucket];
+    }
+
+    /**
+    @brief Count transferred bytes
+    @param nofBytes Number of bytes
+    */
+    static void addBytes(const uint16_t nofBytes) __attribute__((always_inline))
+    {
+        s_nofBytes += nofBytes;
+    }
+
+    /// @brief Reset all counters
+    static void reset()
+    {
+        s_nofTransactions = 0;
+        s_nofBytes = 0;
+        s_nofTicks = 0;
+        s_maxTicks = 0;
+        for (uint8_t bucket = 0; bucket < t_nofBuckets; ++bucket)
+        {
+            s_histogram[bucket] = 0;
+        }
+    }
+
+    /**
+    @brief Get the number of histogram buckets
+    @result Number of buckets
+    */
+    static constexpr uint8_t getNofBuckets()
+    {
+        return t_nofBuckets;
+    }
+
+    /**
+    @brief Get the number of transactions since the last reset
+    @result Number of SS cycles
+    */
+    static uint32_t getNofTransactions()
+    {
+        return s_nofTransactions;
+    }
+
+    /**
+    @brief Get the number of bytes since the last reset
+    @result Number of bytes on the wire (both directions count once per clocked byte)
+    */
+    static uint32_t getNofBytes()
+    {
+        return s_nofBytes;
+    }
+
+    /**
+    @brief Get the accumulated duration of all transactions since the last reset, i.e. the bus time used by the device
+    @result Duration in timer ticks
+    */
+    static uint32_t getNofTicks()
+    {
+        return s_nofTicks;
+    }
+
+    /**
+    @brief Get the duration of the longest transaction since the last reset
+    @result Duration in timer ticks
+    */
+    static uint16_t getMaxTicks()
+    {
+        return s_maxTicks;
+    }
+
+    /**
+    @brief Get a histogram bucket
+    @param bucket Bucket index (0..t_nofBuckets-1)
+    @result Number of transactions with a duration of 2^bucket..2^(bucket+1)-1 timer ticks
+    */
+    static uint16_t getHistogram(const uint8_t bucket)
+    {
+        return s_histogram[bucket];
+    }
+
+    /**
+    @brief Write all counters in text form, e.g. "3: 120 t, 960 B, 48000 c, max 812 c, 0 0 0 0 0 0 110 10\n"
+    @tparam Output Any class implementing a static putc(char) method, e.g. a UART driver or HD44780
+    */
+    template <typename Output>
+    static void dump()
+    {
+        typedef HD44780_Stream<Output> Stream;
+
+        Stream::putu8(t_deviceId);
+        putString<Output>(": ");
+        Stream::putu32(s_nofTransactions);
+        putString<Output>(" t, ");
+        Stream::putu32(s_nofBytes);
+        putString<Output>(" B, ");
+        Stream::putu32(s_nofTicks);
+        putString<Output>(" c, max ");
+        Stream::putu16(s_maxTicks);
+        putString<Output>(" c,");
+        for (uint8_t bucket = 0; bucket < t_nofBuckets; ++bucket)
+        {
+            Output::putc(' ');
+            Stream::putu16(s_histogram[bucket]);
+        }
+        Output::putc('\n');
+    }
+
+    private:
+
+    template <typename Output>
+    static void putString(const char * string)
+    {
+        while (*string != '\0')
+        {
+            Output::putc(*string++);
+        }
+    }
+
+    static uint16_t s_start; // Time stamp of the transaction in progress
+    static uint32_t s_nofTransactions;
+    static uint32_t s_nofBytes;
+    static uint32_t s_nofTicks;
+    static uint16_t s_maxTicks;
+    static uint16_t s_histogram[t_nofBuckets];
+};
+
+// Static initialization
+template <typename Timer, uint8_t t_deviceId, uint8_t t_nofBuckets>
+uint16_t SPIStatistics<Timer, t_deviceId, t_nofBuckets>::s_start = 0;
+
+// Static initialization
+template <typename Timer, uint8_t t_deviceId, uint8_t t_nofBuckets>
+uint32_t SPIStatistics<Timer, t_deviceId, t_nofBuckets>::s_nofTransactions = 0;
+
+// Static initialization
+template <typename Timer, uint8_t t_deviceId, uint8_t t_nofBuckets>
+uint32_t SPIStatistics<Timer, t_deviceId, t_nofBuckets>::s_nofBytes = 0;
+
+// Static initialization
+template <typename Timer, uint8_t t_deviceId, uint8_t t_nofBuckets>
+uint32_t SPIStatistics<Timer, t_deviceId, t_nofBuckets>::s_nofTicks = 0;
+
+// Static initialization
+template <typename Timer, uint8_t t_deviceId, uint8_t t_nofBuckets>
+uint16_t SPIStatistics<Timer, t_deviceId, t_nofBuckets>::s_maxTicks = 0;
+
+// Static initialization
+template <typename Timer, uint8_t t_deviceId, uint8_t t_nofBuckets>
+uint16_t SPIStatistics<Timer, t_deviceId, t_nofBuckets>::s_histogram[t_nofBuckets];
+
+/**
+@brief Chip select pin which records the transactions of its device
+@tparam SSPin Pin driver class implementing static methods high() and low(), e.g. SPIDevicePin
+@tparam Statistics Statistics policy, e.g. SPIStatistics or SPINoStatistics
+@note Usage: _25LC512<SPIMaster, SPIInstrumentedPin<SSPin, EEPROMStatistics>>. All other methods of SSPin are inherited
+*/
+template <typename SSPin, typename Statistics>
+class SPIInstrumentedPin : public SSPin
+{
+    public:
+
+    /// @brief Start transaction and select device (active low)
+    static void low() __attribute__((always_inline))
+    {
+        Statistics::begin();
+        SSPin::low();
+    }
+
+    /// @brief Deselect device (active low) and finish transaction
+    static void high() __attribute__((always_inline))
+    {
+        SSPin::high();
+        Statistics::end();
+    }
+};
+
+/**
+@brief SPI master which counts the bytes transferred to/from one device
+Only the methods used by the driver are instantiated, so SPIMaster needs to implement only these
+@tparam SPIMaster SPI master driver class
+@tparam Statistics Statistics policy, e.g. SPIStatistics or SPINoStatistics
+@note Usage: _25LC512<SPIInstrumentedMaster<SPIMaster, EEPROMStatistics>, SPIInstrumentedPin<SSPin, EEPROMStatistics>>. All other methods of SPIMaster are inherited
+*/
+template <typename SPIMaster, typename Statistics>
+class SPIInstrumentedMaster : public SPIMaster
+{
+    public:
+
+    static void put(const uint8_t data) __attribute__((always_inline))
+    {
+        Statistics::addBytes(1);
+        SPIMaster::put(data);
+    }
+
+    static void put(const uint8_t * const data, const uint16_t nofBytes) __attribute__((always_inline))
+    {
+        Statistics::addBytes(nofBytes);
+        SPIMaster::put(data, nofBytes);
+    }
+
+    static uint8_t get() __attribute__((always_inline))
+    {
+        Statistics::addBytes(1);
+        return SPIMaster::get();
+    }
+
+    static void get(uint8_t * const data, const uint16_t nofBytes) __attribute__((always_inline))
+    {
+        Statistics::addBytes(nofBytes);
+        SPIMaster::get(data, nofBytes);
+    }
+
+    static uint8_t transfer(const uint8_t data) __attribute__((always_inline))
+    {
+        Statistics::addBytes(1);
+        return SPIMaster::transfer(data);
+    }
+
+    static void startTransfer(const uint8_t data) __attribute__((always_inline))
+    {
+        Statistics::addBytes(1);
+        SPIMaster::startTransfer(data);
+    }
+};
+
+#endif
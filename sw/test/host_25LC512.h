@@ -0,0 +1,240 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOST_25LC512_H
+#define HOST_25LC512_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "host_spi.h"
+
+/**
+@brief Emulated SPI EEPROM 25LC512
+Implements READ, WRITE (with wrap-around within a page), WREN, WRDI, RDSR, PE, SE and CE. Write and erase cycles keep WIP set for the modeled cycle time.
+Instructions other than RDSR while a cycle is in progress and write instructions without write enable are ignored and counted as errors
+*/
+class Host25LC512 : public HostSPIDevice
+{
+    public:
+
+    /**
+    @brief Constructor
+    @param cycleTime_ns Duration of the internal write/erase cycle in ns
+    */
+    explicit Host25LC512(const uint64_t cycleTime_ns = 5000000)
+    : m_cycleTime_ns(cycleTime_ns)
+    {
+        memset(m_memory, 0xFF, sizeof(m_memory));
+    }
+
+    /**
+    @brief Access the memory array directly, e.g. to prepare or corrupt its content
+    @result Memory array of 65536 bytes
+    */
+    uint8_t * getMemory()
+    {
+        return m_memory;
+    }
+
+    /**
+    @brief Get the number of internal write/erase cycles
+    @result Number of cycles
+    */
+    uint32_t getNofCycles() const
+    {
+        return m_nofCycles;
+    }
+
+    /**
+    @brief Get the number of protocol errors
+    @result Number of ignored instructions
+    */
+    uint32_t getNofErrors() const
+    {
+        return m_nofErrors;
+    }
+
+    void select() override
+    {
+        m_count = 0;
+        m_nofData = 0;
+    }
+
+    void deselect() override
+    {
+        switch (m_instruction)
+        {
+            case INSTRUCTION_WREN:
+            m_writeEnabled = true;
+            break;
+
+            case INSTRUCTION_WRDI:
+            m_writeEnabled = false;
+            break;
+
+            case INSTRUCTION_WRITE:
+            if (m_count >= 3 && m_nofData > 0 && startCycle())
+            {
+                const uint16_t page = m_address & ~(PAGE_SIZE - 1);
+                for (uint16_t idx = 0; idx < m_nofData && idx < PAGE_SIZE; ++idx)
+                {
+                    m_memory[page | ((m_address + idx) & (PAGE_SIZE - 1))] = m_page[idx];
+                }
+            }
+            break;
+
+            case INSTRUCTION_PE:
+            case INSTRUCTION_SE:
+            if (m_count >= 3 && startCycle())
+            {
+                const uint16_t size = (m_instruction == INSTRUCTION_PE) ? PAGE_SIZE : SECTOR_SIZE;
+                memset(m_memory + (m_address & ~(size - 1)), 0xFF, size);
+            }
+            break;
+
+            case INSTRUCTION_CE:
+            if (startCycle())
+            {
+                memset(m_memory, 0xFF, sizeof(m_memory));
+            }
+            break;
+
+            default:
+            break;
+        }
+        m_instruction = INSTRUCTION_NONE;
+    }
+
+    uint8_t transfer(const uint8_t mosi) override
+    {
+        const uint32_t idx = m_count++;
+
+        if (idx == 0)
+        {
+            m_instruction = mosi;
+            if (isBusy() && mosi != INSTRUCTION_RDSR)
+            {
+                ++m_nofErrors;
+                m_instruction = INSTRUCTION_NONE;
+            }
+            return 0xFF;
+        }
+
+        switch (m_instruction)
+        {
+            case INSTRUCTION_RDSR:
+            return (isBusy() ? STATUS_WIP : 0) | (m_writeEnabled ? STATUS_WEL : 0);
+
+            case INSTRUCTION_READ:
+            if (idx < 3)
+            {
+                putAddress(idx, mosi);
+                return 0xFF;
+            }
+            return m_memory[m_address++];
+
+            case INSTRUCTION_WRITE:
+            if (idx < 3)
+            {
+                putAddress(idx, mosi);
+            }
+            else
+            {
+                // Data exceeding the page wraps around and overwrites the first bytes
+                m_page[m_nofData % PAGE_SIZE] = mosi;
+                ++m_nofData;
+            }
+            return 0xFF;
+
+            case INSTRUCTION_PE:
+            case INSTRUCTION_SE:
+            if (idx < 3)
+            {
+                putAddress(idx, mosi);
+            }
+            return 0xFF;
+
+            default:
+            return 0xFF;
+        }
+    }
+
+    private:
+
+    bool isBusy() const
+    {
+        return HostClock::now() < m_busyUntil;
+    }
+
+    void putAddress(const uint32_t idx, const uint8_t value)
+    {
+        m_address = (idx == 1) ? (value << 8) : (m_address | value);
+    }
+
+    // Start internal cycle, if writing is enabled
+    bool startCycle()
+    {
+        if (!m_writeEnabled)
+        {
+            ++m_nofErrors;
+            return false;
+        }
+
+        m_writeEnabled = false;
+        m_busyUntil = HostClock::now() + m_cycleTime_ns;
+        ++m_nofCycles;
+        return true;
+    }
+
+    static constexpr uint16_t PAGE_SIZE = 128;
+    static constexpr uint16_t SECTOR_SIZE = 16384;
+
+    enum
+    {
+        STATUS_WIP = 0x01,
+        STATUS_WEL = 0x02
+    };
+
+    enum
+    {
+        INSTRUCTION_NONE = 0x00,
+        INSTRUCTION_WRSR = 0x01,
+        INSTRUCTION_WRITE = 0x02,
+        INSTRUCTION_READ = 0x03,
+        INSTRUCTION_WRDI = 0x04,
+        INSTRUCTION_RDSR = 0x05,
+        INSTRUCTION_WREN = 0x06,
+        INSTRUCTION_PE = 0x42,
+        INSTRUCTION_CE = 0xC7,
+        INSTRUCTION_SE = 0xD8
+    };
+
+    const uint64_t m_cycleTime_ns;
+    uint64_t m_busyUntil = 0;
+    uint8_t m_memory[65536];
+    uint8_t m_page[PAGE_SIZE];
+    uint32_t m_count = 0;
+    uint32_t m_nofData = 0;
+    uint32_t m_nofCycles = 0;
+    uint32_t m_nofErrors = 0;
+    uint16_t m_address = 0;
+    uint8_t m_instruction = INSTRUCTION_NONE;
+    bool m_writeEnabled = false;
+};
+
+#endif
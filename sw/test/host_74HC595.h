@@ -0,0 +1,83 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOST_74HC595_H
+#define HOST_74HC595_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "host_spi.h"
+
+/**
+@brief Emulated daisy chain of 74HC595 shift registers
+Every byte is shifted into the chain, the rising edge of SS (RCLK) latches the chain to the outputs
+@tparam t_nofDevices Number of daisy-chained devices
+*/
+template <uint8_t t_nofDevices = 1>
+class Host74HC595 : public HostSPIDevice
+{
+    public:
+
+    Host74HC595()
+    {
+        memset(m_shift, 0, sizeof(m_shift));
+        memset(m_outputs, 0, sizeof(m_outputs));
+    }
+
+    /**
+    @brief Get latched outputs
+    @param byteIdx Byte index in the order of transfer, i.e. byte 0 has been shifted first
+    @result Output values
+    */
+    uint8_t getOutputs(const uint8_t byteIdx) const
+    {
+        return m_outputs[byteIdx];
+    }
+
+    /**
+    @brief Get the number of latch pulses
+    @result Number of rising edges of RCLK
+    */
+    uint32_t getNofLatches() const
+    {
+        return m_nofLatches;
+    }
+
+    void deselect() override
+    {
+        memcpy(m_outputs, m_shift, sizeof(m_outputs));
+        ++m_nofLatches;
+    }
+
+    uint8_t transfer(const uint8_t mosi) override
+    {
+        // The first byte of the chain is shifted out to QH' of the last device
+        const uint8_t miso = m_shift[0];
+        memmove(m_shift, m_shift + 1, t_nofDevices - 1);
+        m_shift[t_nofDevices - 1] = mosi;
+        return miso;
+    }
+
+    private:
+
+    uint8_t m_shift[t_nofDevices];
+    uint8_t m_outputs[t_nofDevices];
+    uint32_t m_nofLatches = 0;
+};
+
+#endif
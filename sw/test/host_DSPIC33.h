@@ -0,0 +1,229 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOST_DSPIC33_H
+#define HOST_DSPIC33_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "host_spi.h"
+#include "DSPIC33.h"
+
+/**
+@brief Emulated SPI protocol of the dsPIC33 firmware (see DSPIC33)
+Parameter frames are address/value pairs, block frames start with DSPIC33_BLOCK_PREFIX and access a 16 bit word memory. Read data is shifted out starting with the first data word.
+Incomplete frames and checksum mismatches of received data are counted as errors
+*/
+class HostDSPIC33 : public HostSPIDevice
+{
+    public:
+
+    /// @brief Number of words of the block address space. Addresses wrap around
+    static constexpr uint16_t MEMORY_SIZE = 0x100;
+
+    /**
+    @brief Get a parameter
+    @param address Parameter address
+    @result Last value received
+    */
+    uint8_t getParameter(const uint8_t address) const
+    {
+        return m_parameters[address];
+    }
+
+    /**
+    @brief Get the number of received parameters
+    @result Number of address/value pairs
+    */
+    uint32_t getNofParameterWrites() const
+    {
+        return m_nofParameterWrites;
+    }
+
+    /**
+    @brief Access the word memory directly, e.g. to prepare meter values
+    @param address Word address
+    @result Reference to memory word
+    */
+    uint16_t & getWord(const uint16_t address)
+    {
+        return m_memory[address % MEMORY_SIZE];
+    }
+
+    /**
+    @brief Get the number of protocol errors
+    @result Number of incomplete frames and checksum mismatches
+    */
+    uint32_t getNofErrors() const
+    {
+        return m_nofErrors;
+    }
+
+    void select() override
+    {
+        m_count = 0;
+        m_block = false;
+        m_rxSum = 0;
+        m_txSum = 0;
+    }
+
+    void deselect() override
+    {
+        // Parameter frames consist of pairs, block frames of header, data words and checksum
+        const uint32_t length = m_block ? getBlockLength() : ((m_count + 1) & ~1U);
+        if (m_count != length)
+        {
+            ++m_nofErrors;
+        }
+    }
+
+    uint8_t transfer(const uint8_t mosi) override
+    {
+        const uint32_t idx = m_count++;
+
+        if (idx == 0)
+        {
+            m_block = (mosi == DSPIC33_BLOCK_PREFIX);
+        }
+
+        if (!m_block)
+        {
+            if (idx & 1)
+            {
+                m_parameters[m_parameterAddress] = mosi;
+                ++m_nofParameterWrites;
+            }
+            else
+            {
+                m_parameterAddress = mosi;
+            }
+            return 0xFF;
+        }
+
+        switch (idx)
+        {
+            case 0:
+            return 0xFF;
+
+            case 1:
+            m_command = mosi;
+            return 0xFF;
+
+            case 2:
+            case 4:
+            m_word = mosi << 8;
+            return 0xFF;
+
+            case 3:
+            m_address = m_word | mosi;
+            return 0xFF;
+
+            case 5:
+            m_nofWords = m_word | mosi;
+            return 0xFF;
+
+            default:
+            break;
+        }
+
+        // Data words and checksum word, MSB first
+        const uint32_t wordIdx = (idx - HEADER_SIZE) / 2;
+        const bool high = !((idx - HEADER_SIZE) & 1);
+        if (wordIdx >= static_cast<uint32_t>(m_nofWords) + (hasChecksum() ? 1 : 0))
+        {
+            ++m_nofErrors;
+            return 0xFF;
+        }
+
+        const bool checksum = (wordIdx == m_nofWords);
+        if (high)
+        {
+            m_word = mosi << 8;
+            if (checksum)
+            {
+                m_miso = m_txSum;
+            }
+            else
+            {
+                m_miso = isReading() ? getWord(m_address + wordIdx) : 0xFFFF;
+                m_txSum += m_miso;
+            }
+            return m_miso >> 8;
+        }
+
+        const uint16_t value = m_word | mosi;
+        if (checksum)
+        {
+            if (isWriting() && value != m_rxSum)
+            {
+                ++m_nofErrors;
+            }
+        }
+        else if (isWriting())
+        {
+            getWord(m_address + wordIdx) = value;
+            m_rxSum += value;
+        }
+        return m_miso & 0xFF;
+    }
+
+    private:
+
+    // Prefix, command, address word, word count
+    static constexpr uint8_t HEADER_SIZE = 6;
+
+    bool hasChecksum() const
+    {
+        return m_command & DSPIC33_COMMAND_CHECKSUM;
+    }
+
+    bool isWriting() const
+    {
+        return m_command & DSPIC33_COMMAND_WRITE;
+    }
+
+    bool isReading() const
+    {
+        return m_command & DSPIC33_COMMAND_READ;
+    }
+
+    uint32_t getBlockLength() const
+    {
+        if (m_count < HEADER_SIZE)
+        {
+            return HEADER_SIZE;
+        }
+        return HEADER_SIZE + 2 * (static_cast<uint32_t>(m_nofWords) + (hasChecksum() ? 1 : 0));
+    }
+
+    uint8_t m_parameters[0x100] = {};
+    uint16_t m_memory[MEMORY_SIZE] = {};
+    uint32_t m_nofParameterWrites = 0;
+    uint32_t m_nofErrors = 0;
+    uint32_t m_count = 0;
+    uint8_t m_parameterAddress = 0;
+    uint8_t m_command = 0;
+    uint16_t m_word = 0;
+    uint16_t m_address = 0;
+    uint16_t m_nofWords = 0;
+    uint16_t m_miso = 0;
+    uint16_t m_rxSum = 0;
+    uint16_t m_txSum = 0;
+    bool m_block = false;
+};
+
+#endif
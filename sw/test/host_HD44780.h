@@ -0,0 +1,243 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOST_HD44780_H
+#define HOST_HD44780_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "host_spi.h"
+
+/**
+@brief Emulated HD44780 LCD controller connected via 74HC595 shift register (see HD44780_74HC595_Port)
+The shift register outputs are latched on the rising edge of SS. The controller latches D4:7 on the falling edge of EN, starting in 8 bit mode after power-on.
+Instructions received before the previous one has been executed are counted as timing errors
+@tparam t_ENBit 74HC595 output connected to EN pin (0..7)
+@tparam t_RSBit 74HC595 output connected to RS pin (0..7)
+@tparam t_DBShift First of four consecutive 74HC595 outputs connected to D4:7 (0..4)
+*/
+template <uint8_t t_ENBit = 0, uint8_t t_RSBit = 2, uint8_t t_DBShift = 4>
+class HostHD44780 : public HostSPIDevice
+{
+    public:
+
+    // Execution times in ns
+    static constexpr uint64_t POWER_ON_TIME = 15000000;
+    static constexpr uint64_t RESET_TIME = 4100000;
+    static constexpr uint64_t EXECUTION_TIME = 37000;
+    static constexpr uint64_t EXECUTION_TIME_LONG = 1520000;
+
+    HostHD44780()
+    : m_busyUntil(HostClock::now() + POWER_ON_TIME)
+    {
+        memset(m_DDRAM, ' ', sizeof(m_DDRAM));
+    }
+
+    /**
+    @brief Get a character from the display data RAM
+    @param address DDRAM address
+    @result Character code
+    */
+    char getDDRAM(const uint8_t address) const
+    {
+        return m_DDRAM[address & 0x7F];
+    }
+
+    /**
+    @brief Get a pixel row of a user character from the character generator RAM
+    @param address CG RAM address, i.e. character code * 8 + pixel row
+    @result Pixel row (bits 4:0)
+    */
+    uint8_t getCGRAM(const uint8_t address) const
+    {
+        return m_CGRAMData[address & 0x3F];
+    }
+
+    /**
+    @brief Get the number of executed instructions
+    @result Number of instructions including data writes
+    */
+    uint32_t getNofInstructions() const
+    {
+        return m_nofInstructions;
+    }
+
+    /**
+    @brief Get the number of timing errors
+    @result Number of instructions received while the controller was busy
+    */
+    uint32_t getNofErrors() const
+    {
+        return m_nofErrors;
+    }
+
+    /**
+    @brief Check the interface mode
+    @result true if the controller has been switched to 4 bit mode
+    */
+    bool isFourBitMode() const
+    {
+        return m_fourBit;
+    }
+
+    /**
+    @brief Check the display control
+    @result true if the display is switched on
+    */
+    bool isDisplayOn() const
+    {
+        return m_displayOn;
+    }
+
+    uint8_t transfer(const uint8_t mosi) override
+    {
+        m_shift = mosi;
+        return 0xFF;
+    }
+
+    void deselect() override
+    {
+        // Rising edge of SS latches the shift register to the outputs
+        const bool EN = m_shift & _BV(t_ENBit);
+        if (m_EN && !EN)
+        {
+            onNibble((m_shift >> t_DBShift) & 0x0F, m_shift & _BV(t_RSBit));
+        }
+        m_EN = EN;
+    }
+
+    private:
+
+    void onNibble(const uint8_t nibble, const bool RS)
+    {
+        if (!m_fourBit)
+        {
+            // Lower data pins D0:3 are not connected
+            execute(nibble << 4, RS);
+        }
+        else if (!m_pending)
+        {
+            m_upperNibble = nibble;
+            m_pending = true;
+        }
+        else
+        {
+            m_pending = false;
+            execute((m_upperNibble << 4) | nibble, RS);
+        }
+    }
+
+    void execute(const uint8_t value, const bool RS)
+    {
+        if (HostClock::now() < m_busyUntil)
+        {
+            ++m_nofErrors;
+        }
+        ++m_nofInstructions;
+
+        uint64_t executionTime = EXECUTION_TIME;
+        if (RS)
+        {
+            if (m_CGRAM)
+            {
+                m_CGRAMData[m_address] = value & 0x1F;
+                m_address = (m_address + 1) & 0x3F;
+            }
+            else
+            {
+                m_DDRAM[m_address] = value;
+                m_address = nextAddress(m_address);
+            }
+        }
+        else if (value & 0x80)
+        {
+            m_address = value & 0x7F;
+            m_CGRAM = false;
+        }
+        else if (value & 0x40)
+        {
+            m_address = value & 0x3F;
+            m_CGRAM = true;
+        }
+        else if (value & 0x20)
+        {
+            // Function set. The first one after power-on (soft reset) is executed slowly
+            executionTime = (m_nofInstructions == 1) ? RESET_TIME : EXECUTION_TIME;
+            m_fourBit = !(value & 0x10);
+            m_twoLines = value & 0x08;
+        }
+        else if (value & 0x10)
+        {
+            // Cursor/display shift is not emulated
+        }
+        else if (value & 0x08)
+        {
+            m_displayOn = value & 0x04;
+        }
+        else if (value & 0x04)
+        {
+            // Entry mode: Only increment without shift is emulated
+        }
+        else if (value & 0x02)
+        {
+            m_address = 0;
+            m_CGRAM = false;
+            executionTime = EXECUTION_TIME_LONG;
+        }
+        else if (value & 0x01)
+        {
+            memset(m_DDRAM, ' ', sizeof(m_DDRAM));
+            m_address = 0;
+            m_CGRAM = false;
+            executionTime = EXECUTION_TIME_LONG;
+        }
+
+        m_busyUntil = HostClock::now() + executionTime;
+    }
+
+    // DDRAM address increment: Two line mode uses 0x00..0x27 and 0x40..0x67
+    uint8_t nextAddress(const uint8_t address) const
+    {
+        if (!m_twoLines)
+        {
+            return (address < 0x4F) ? (address + 1) : 0;
+        }
+        if (address == 0x27)
+        {
+            return 0x40;
+        }
+        return (address == 0x67) ? 0 : (address + 1);
+    }
+
+    uint64_t m_busyUntil;
+    char m_DDRAM[0x80];
+    uint8_t m_CGRAMData[0x40] = {};
+    uint32_t m_nofInstructions = 0;
+    uint32_t m_nofErrors = 0;
+    uint8_t m_shift = 0;
+    uint8_t m_address = 0;
+    uint8_t m_upperNibble = 0;
+    bool m_EN = false;
+    bool m_pending = false;
+    bool m_fourBit = false;
+    bool m_twoLines = false;
+    bool m_CGRAM = false;
+    bool m_displayOn = false;
+};
+
+#endif
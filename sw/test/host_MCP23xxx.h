@@ -0,0 +1,418 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOST_MCP23XXX_H
+#define HOST_MCP23XXX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "host_spi.h"
+#include "host_twi.h"
+
+/**
+@brief Emulated register file of the MCP23xxx port expanders (IOCON.BANK = 0)
+Implements sequential and byte mode register access, input polarity and interrupt-on-change with capture.
+Port values are 16 bit for two ports, port A (MSB) + port B (LSB), so bit positions equal MCP23S17PinIdx. Devices with one port use the LSB, so bit positions equal MCP23x08PinIdx
+@tparam t_nofPorts Number of 8 bit ports (1 for MCP23S08/MCP23008, 2 for MCP23S17/MCP23017)
+*/
+template <uint8_t t_nofPorts>
+class HostMCP23xxx
+{
+    static_assert(t_nofPorts == 1 || t_nofPorts == 2, "Devices have one or two ports");
+
+    public:
+
+    /**
+    @brief Drive the input pins
+    Changes of pins with interrupt-on-change enabled set the interrupt flags. The port value is captured by the first flag of each port
+    @param levels Pin levels, i.e. A (MSB) + B (LSB) for two ports
+    */
+    void setInputs(const uint16_t levels)
+    {
+        const uint16_t previous = m_levels;
+        m_levels = levels;
+
+        for (uint8_t port = 0; port < t_nofPorts; ++port)
+        {
+            const uint8_t changed = getByte(previous ^ levels, port);
+            const uint8_t mismatch = getByte(levels, port) ^ get(IPOL, port) ^ get(DEFVAL, port);
+            const uint8_t compare = get(INTCON, port);
+            const uint8_t flags = ((changed & ~compare) | (mismatch & compare)) & get(GPINTEN, port) & get(IODIR, port);
+
+            if (flags != 0)
+            {
+                if (get(INTF, port) == 0)
+                {
+                    get(INTCAP, port) = getGPIO(port);
+                }
+                get(INTF, port) |= flags;
+            }
+        }
+    }
+
+    /**
+    @brief Get the level of the output pins
+    @result Output latches of pins configured as outputs, i.e. A (MSB) + B (LSB) for two ports. Input pins read as 0
+    */
+    uint16_t getOutputs() const
+    {
+        return getPortValue(OLAT) & ~getPortValue(IODIR);
+    }
+
+    /**
+    @brief Get a register pair (two ports only)
+    @param address Address of register A, e.g. 0x00 for IODIRA/IODIRB
+    @result Register values A (MSB) + B (LSB)
+    */
+    uint16_t getRegisterPair(const uint8_t address) const requires (t_nofPorts == 2)
+    {
+        return (m_registers[address] << 8) | m_registers[address + 1];
+    }
+
+    /**
+    @brief Get a register
+    @param address Register address
+    @result Register value
+    */
+    uint8_t getRegister(const uint8_t address) const
+    {
+        return m_registers[address];
+    }
+
+    /**
+    @brief Check the interrupt output (INTA and INTB mirrored)
+    @result true if any interrupt flag is set
+    */
+    bool hasInterrupt() const
+    {
+        return getPortValue(INTF) != 0;
+    }
+
+    protected:
+
+    HostMCP23xxx()
+    {
+        // Power-on reset: All pins are inputs
+        for (uint8_t port = 0; port < t_nofPorts; ++port)
+        {
+            get(IODIR, port) = 0xFF;
+        }
+    }
+
+    ~HostMCP23xxx() = default;
+
+    /**
+    @brief Check hardware addressing of SPI devices
+    @result true if IOCON.HAEN is set
+    */
+    bool isHardwareAddressEnabled() const
+    {
+        return m_registers[getAddress(IOCON, 0)] & _BV(HAEN);
+    }
+
+    /**
+    @brief Set the address pointer, i.e. the register address of a transfer
+    @param address Register address
+    */
+    void setAddressPointer(const uint8_t address)
+    {
+        m_address = address % NOF_REGISTERS;
+    }
+
+    /**
+    @brief Read the register at the address pointer
+    @result Register value
+    */
+    uint8_t readNext()
+    {
+        const uint8_t value = readRegister(m_address);
+        incrementAddressPointer();
+        return value;
+    }
+
+    /**
+    @brief Write the register at the address pointer
+    @param value Register value
+    */
+    void writeNext(const uint8_t value)
+    {
+        writeRegister(m_address, value);
+        incrementAddressPointer();
+    }
+
+    private:
+
+    // Register indices. The address of a register is index * number of ports + port
+    enum
+    {
+        IODIR,
+        IPOL,
+        GPINTEN,
+        DEFVAL,
+        INTCON,
+        IOCON,
+        GPPU,
+        INTF,
+        INTCAP,
+        GPIO,
+        OLAT,
+        NOF_REGISTERS = 11 * t_nofPorts
+    };
+
+    // IOCON register bits
+    enum
+    {
+        HAEN = 3,
+        SEQOP = 5
+    };
+
+    static constexpr uint8_t getAddress(const uint8_t reg, const uint8_t port)
+    {
+        return reg * t_nofPorts + port;
+    }
+
+    static uint8_t getByte(const uint16_t value, const uint8_t port)
+    {
+        return value >> (8 * (t_nofPorts - 1 - port));
+    }
+
+    uint8_t & get(const uint8_t reg, const uint8_t port)
+    {
+        return m_registers[getAddress(reg, port)];
+    }
+
+    uint8_t get(const uint8_t reg, const uint8_t port) const
+    {
+        return m_registers[getAddress(reg, port)];
+    }
+
+    uint16_t getPortValue(const uint8_t reg) const
+    {
+        uint16_t value = 0;
+        for (uint8_t port = 0; port < t_nofPorts; ++port)
+        {
+            value = (value << 8) | get(reg, port);
+        }
+        return value;
+    }
+
+    // Pin levels of inputs (with polarity inversion) and output latches of outputs
+    uint8_t getGPIO(const uint8_t port) const
+    {
+        const uint8_t valueIODIR = get(IODIR, port);
+        return ((getByte(m_levels, port) ^ get(IPOL, port)) & valueIODIR) | (get(OLAT, port) & ~valueIODIR);
+    }
+
+    void incrementAddressPointer()
+    {
+        // Sequential operation increments the address pointer
+        if (!(m_registers[getAddress(IOCON, 0)] & _BV(SEQOP)))
+        {
+            m_address = (m_address + 1) % NOF_REGISTERS;
+        }
+    }
+
+    uint8_t readRegister(const uint8_t address)
+    {
+        const uint8_t reg = address / t_nofPorts;
+        const uint8_t port = address % t_nofPorts;
+        switch (reg)
+        {
+            case IOCON:
+            // Both IOCON addresses access the same register
+            return get(IOCON, 0);
+
+            case GPIO:
+            // Reading GPIO clears the interrupt of the port
+            get(INTF, port) = 0;
+            return getGPIO(port);
+
+            case INTCAP:
+            // Reading INTCAP clears the interrupt of the port
+            get(INTF, port) = 0;
+            return m_registers[address];
+
+            default:
+            return m_registers[address];
+        }
+    }
+
+    void writeRegister(const uint8_t address, const uint8_t value)
+    {
+        const uint8_t reg = address / t_nofPorts;
+        const uint8_t port = address % t_nofPorts;
+        switch (reg)
+        {
+            case IOCON:
+            get(IOCON, 0) = value;
+            break;
+
+            case INTF:
+            case INTCAP:
+            // Read-only
+            break;
+
+            case GPIO:
+            // Writing GPIO modifies the output latch
+            get(OLAT, port) = value;
+            break;
+
+            default:
+            m_registers[address] = value;
+            break;
+        }
+    }
+
+    uint8_t m_registers[NOF_REGISTERS] = {};
+    uint16_t m_levels = 0xFFFF;
+    uint8_t m_address = 0;
+};
+
+/**
+@brief Emulated SPI port expander MCP23S17 or MCP23S08
+An access is one SS cycle: Opcode 0b0100AAA plus R/W bit, register address, register values. Without hardware addressing (IOCON.HAEN), the device responds to address 0 only
+@tparam t_nofPorts Number of 8 bit ports (1 for MCP23S08, 2 for MCP23S17)
+*/
+template <uint8_t t_nofPorts>
+class HostMCP23xxxSPI : public HostSPIDevice, public HostMCP23xxx<t_nofPorts>
+{
+    typedef HostMCP23xxx<t_nofPorts> Registers;
+
+    public:
+
+    /**
+    @brief Constructor
+    @param hardwareAddress Level of the address pins A2..A0 (MCP23S17) or A1..A0 (MCP23S08)
+    */
+    explicit HostMCP23xxxSPI(const uint8_t hardwareAddress = 0)
+    : m_hardwareAddress(hardwareAddress)
+    {}
+
+    void select() override
+    {
+        m_count = 0;
+        m_addressed = false;
+    }
+
+    uint8_t transfer(const uint8_t mosi) override
+    {
+        const uint32_t idx = m_count++;
+
+        if (idx == 0)
+        {
+            const uint8_t address = Registers::isHardwareAddressEnabled() ? m_hardwareAddress : 0;
+            m_addressed = (mosi & 0xFE) == (0x40 | (address << 1));
+            m_read = mosi & 0x01;
+            return 0xFF;
+        }
+
+        if (!m_addressed)
+        {
+            return 0xFF;
+        }
+
+        if (idx == 1)
+        {
+            Registers::setAddressPointer(mosi);
+            return 0xFF;
+        }
+
+        if (m_read)
+        {
+            return Registers::readNext();
+        }
+
+        Registers::writeNext(mosi);
+        return 0xFF;
+    }
+
+    private:
+
+    const uint8_t m_hardwareAddress;
+    uint32_t m_count = 0;
+    bool m_addressed = false;
+    bool m_read = false;
+};
+
+/**
+@brief Emulated I2C port expander MCP23017 or MCP23008
+The slave address is 0b0100AAA. The first byte of a write sets the address pointer, all further bytes are register values. Reads start at the address pointer
+@tparam t_nofPorts Number of 8 bit ports (1 for MCP23008, 2 for MCP23017)
+*/
+template <uint8_t t_nofPorts>
+class HostMCP23xxxI2C : public HostTWIDevice, public HostMCP23xxx<t_nofPorts>
+{
+    typedef HostMCP23xxx<t_nofPorts> Registers;
+
+    public:
+
+    /**
+    @brief Constructor
+    @param hardwareAddress Level of the address pins A2..A0
+    */
+    explicit HostMCP23xxxI2C(const uint8_t hardwareAddress = 0)
+    : m_hardwareAddress(hardwareAddress)
+    {}
+
+    bool start(const uint8_t address) override
+    {
+        if ((address >> 1) != (0x20 | m_hardwareAddress))
+        {
+            return false;
+        }
+
+        m_count = 0;
+        return true;
+    }
+
+    bool write(const uint8_t data) override
+    {
+        if (m_count++ == 0)
+        {
+            Registers::setAddressPointer(data);
+        }
+        else
+        {
+            Registers::writeNext(data);
+        }
+        return true;
+    }
+
+    uint8_t read(const bool) override
+    {
+        return Registers::readNext();
+    }
+
+    private:
+
+    const uint8_t m_hardwareAddress;
+    uint32_t m_count = 0;
+};
+
+/// @brief Emulated SPI port expander MCP23S17
+typedef HostMCP23xxxSPI<2> HostMCP23S17;
+
+/// @brief Emulated SPI port expander MCP23S08
+typedef HostMCP23xxxSPI<1> HostMCP23S08;
+
+/// @brief Emulated I2C port expander MCP23017
+typedef HostMCP23xxxI2C<2> HostMCP23017;
+
+/// @brief Emulated I2C port expander MCP23008
+typedef HostMCP23xxxI2C<1> HostMCP23008;
+
+#endif
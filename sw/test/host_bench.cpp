@@ -0,0 +1,258 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Benchmarks of typical workloads against emulated devices
+// Reported are bytes on the wire, SS cycles and the modeled elapsed time (SPI transfers, driver delays and EEPROM write cycles) at a SPI clock of 8 MHz
+
+#include <stdio.h>
+#include <string.h>
+#include "host_spi.h"
+#include "host_25LC512.h"
+#include "host_MCP23xxx.h"
+#include "host_HD44780.h"
+#include "25LC512.h"
+#include "25LC512_log.h"
+#include "MCP23S17.h"
+#include "HD44780.h"
+#include "HD44780_framebuffer.h"
+
+typedef HostSPIMaster<8000000UL> SPIMaster;
+
+static bool s_passed = true;
+
+/**
+@brief Measurement of one workload
+Counters are reset by the constructor and reported by the destructor
+*/
+class Benchmark
+{
+    public:
+
+    explicit Benchmark(const char * name, const uint32_t nofOperations = 1)
+    : m_name(name), m_nofOperations(nofOperations), m_start(HostClock::now())
+    {
+        HostSPIBus::reset();
+    }
+
+    ~Benchmark()
+    {
+        const double elapsed_us = (HostClock::now() - m_start) / 1000.0;
+        printf("%-28s %8u bytes %6u SS cycles %12.1f us", m_name, static_cast<unsigned>(HostSPIBus::getNofBytes()), static_cast<unsigned>(HostSPIBus::getNofSelects()), elapsed_us);
+        if (m_nofOperations > 1)
+        {
+            printf("  (%u x, %.1f bytes / %.2f us each)", static_cast<unsigned>(m_nofOperations), static_cast<double>(HostSPIBus::getNofBytes()) / m_nofOperations, elapsed_us / m_nofOperations);
+        }
+        printf("\n");
+
+        if (HostSPIBus::getNofErrors() != 0)
+        {
+            printf("  %u bus errors\n", static_cast<unsigned>(HostSPIBus::getNofErrors()));
+            s_passed = false;
+        }
+    }
+
+    private:
+
+    const char * m_name;
+    const uint32_t m_nofOperations;
+    const uint64_t m_start;
+};
+
+static void verify(const bool condition, const char * message)
+{
+    if (!condition)
+    {
+        printf("  verification failed: %s\n", message);
+        s_passed = false;
+    }
+}
+
+// Full redraw of a 4x20 LCD connected via 74HC595
+
+static HostHD44780<> s_lcd;
+typedef HD44780<HD44780_NofCharacters::_4x20, HD44780_74HC595_Port<SPIMaster, HostSSPin<s_lcd>>> Display;
+typedef HD44780_Framebuffer<Display> Framebuffer;
+
+static void benchmarkDisplay()
+{
+    static const uint8_t rowAddress[] = {0x00, 0x40, 0x14, 0x54};
+
+    {
+        Benchmark benchmark("LCD init");
+        Framebuffer::init();
+    }
+
+    for (uint8_t row = 0; row < Framebuffer::getNofRows(); ++row)
+    {
+        Framebuffer::setCursor(row, 0);
+        for (uint8_t column = 0; column < Framebuffer::getNofColumns(); ++column)
+        {
+            Framebuffer::putc('A' + (row * Framebuffer::getNofColumns() + column) % 26);
+        }
+    }
+
+    {
+        Benchmark benchmark("LCD full redraw (4x20)");
+        Framebuffer::refresh();
+    }
+
+    bool match = true;
+    for (uint8_t row = 0; row < Framebuffer::getNofRows(); ++row)
+    {
+        for (uint8_t column = 0; column < Framebuffer::getNofColumns(); ++column)
+        {
+            match = match && (s_lcd.getDDRAM(rowAddress[row] + column) == Framebuffer::getc(row, column));
+        }
+    }
+    verify(match, "LCD content differs from framebuffer");
+
+    Framebuffer::setCursor(2, 8);
+    Framebuffer::puts("12.5");
+    {
+        Benchmark benchmark("LCD partial redraw (4 chars)");
+        Framebuffer::refresh();
+    }
+    verify(s_lcd.getDDRAM(0x14 + 8) == '1' && s_lcd.getDDRAM(0x14 + 11) == '5', "LCD partial redraw");
+    verify(s_lcd.getNofErrors() == 0, "LCD timing violated");
+}
+
+// 4 KB log flush to EEPROM
+
+static Host25LC512 s_eeprom;
+typedef _25LC512<SPIMaster, HostSSPin<s_eeprom>> EEPROM;
+typedef _25LC512_Log<EEPROM, 0x4000, 64> Log;
+
+static void benchmarkEEPROM()
+{
+    uint8_t data[4096];
+    for (uint16_t idx = 0; idx < sizeof(data); ++idx)
+    {
+        data[idx] = idx ^ (idx >> 8);
+    }
+
+    EEPROM::init();
+    Log::format();
+    Log::init();
+
+    const uint16_t nofRecords = (sizeof(data) + Log::maxRecordSize() - 1) / Log::maxRecordSize();
+    {
+        Benchmark benchmark("EEPROM 4 KB log flush", nofRecords);
+        for (uint16_t offset = 0; offset < sizeof(data); offset += Log::maxRecordSize())
+        {
+            const uint16_t length = (sizeof(data) - offset < Log::maxRecordSize()) ? (sizeof(data) - offset) : Log::maxRecordSize();
+            Log::append(data + offset, length);
+        }
+        EEPROM::waitWhileBusy();
+    }
+
+    uint16_t offset = 0;
+    bool match = true;
+    Log::replay([&](Log::Sequence, const uint8_t * record, const uint8_t length)
+    {
+        match = match && (memcmp(record, data + offset, length) == 0);
+        offset += length;
+    });
+    verify(match && offset == sizeof(data), "log replay differs from appended data");
+
+    {
+        Benchmark benchmark("EEPROM 4 KB burst write");
+        EEPROM::write(0, data, static_cast<uint16_t>(sizeof(data)));
+        EEPROM::waitWhileBusy();
+    }
+
+    uint8_t buffer[sizeof(data)];
+    {
+        Benchmark benchmark("EEPROM 4 KB read");
+        EEPROM::read(0, buffer, static_cast<uint16_t>(sizeof(buffer)));
+    }
+    verify(memcmp(buffer, data, sizeof(data)) == 0, "EEPROM content differs");
+    verify(s_eeprom.getNofErrors() == 0, "EEPROM protocol violated");
+}
+
+// Interrupt burst of 4 rotary encoders connected to one MCP23S17
+
+static HostMCP23S17 s_expander;
+static int16_t s_steps[4] = {};
+
+template <uint8_t t_encoder>
+void onStep(const bool clockwise)
+{
+    s_steps[t_encoder] += clockwise ? 1 : -1;
+}
+
+typedef MCP23S17<SPIMaster, HostSSPin<s_expander>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A0, MCP23xxxPinType::ROTENC_QUAD_X4_A, MCP23xxxStaticCallback<onStep<0>>>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A1, MCP23xxxPinType::ROTENC_QUAD_B>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A2, MCP23xxxPinType::ROTENC_QUAD_X4_A, MCP23xxxStaticCallback<onStep<1>>>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A3, MCP23xxxPinType::ROTENC_QUAD_B>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A4, MCP23xxxPinType::ROTENC_QUAD_X4_A, MCP23xxxStaticCallback<onStep<2>>>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A5, MCP23xxxPinType::ROTENC_QUAD_B>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A6, MCP23xxxPinType::ROTENC_QUAD_X4_A, MCP23xxxStaticCallback<onStep<3>>>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A7, MCP23xxxPinType::ROTENC_QUAD_B>> Expander;
+
+static void benchmarkEncoders()
+{
+    // Logical phase states (A, B) of one detent step clockwise. The phases are active low
+    static const uint8_t sequence[] = {0b10, 0b11, 0b01, 0b00};
+    constexpr uint8_t nofDetents = 8;
+
+    {
+        Benchmark benchmark("MCP23S17 init");
+        Expander::init();
+    }
+
+    uint16_t levels = 0xFFFF;
+    uint32_t nofInterrupts = 0;
+    {
+        Benchmark benchmark("MCP23S17 4-encoder burst", 4 * 4 * nofDetents);
+        for (uint8_t detent = 0; detent < nofDetents; ++detent)
+        {
+            for (uint8_t transition = 0; transition < 4; ++transition)
+            {
+                for (uint8_t encoder = 0; encoder < 4; ++encoder)
+                {
+                    // Encoders 0 and 1 turn clockwise, 2 and 3 counter-clockwise
+                    const uint8_t state = (encoder < 2) ? sequence[transition] : sequence[(6 - transition) & 0b11];
+                    const uint8_t shift = 8 + 2 * encoder;
+                    levels = (levels & ~(0b11 << shift)) | ((~((state >> 1) | ((state & 1) << 1)) & 0b11) << shift);
+                    s_expander.setInputs(levels);
+
+                    if (s_expander.hasInterrupt())
+                    {
+                        Expander::onInterrupt();
+                        ++nofInterrupts;
+                    }
+                }
+            }
+        }
+    }
+
+    verify(nofInterrupts == 4 * 4 * nofDetents, "missing encoder interrupts");
+    // Four steps per detent (ROTENC_QUAD_X4_A)
+    constexpr int16_t nofSteps = 4 * nofDetents;
+    verify(s_steps[0] == nofSteps && s_steps[1] == nofSteps && s_steps[2] == -nofSteps && s_steps[3] == -nofSteps, "encoder steps");
+}
+
+int main()
+{
+    benchmarkDisplay();
+    benchmarkEEPROM();
+    benchmarkEncoders();
+
+    printf("%s\n", s_passed ? "PASSED" : "FAILED");
+    return s_passed ? 0 : 1;
+}
@@ -0,0 +1,54 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOST_CLOCK_H
+#define HOST_CLOCK_H
+
+#include <stdint.h>
+
+/**
+@brief Modeled time of host builds
+The time is advanced by the mock SPI master for every transferred byte and by the _delay_us()/_delay_ms() stubs, so it represents the elapsed time on the target, neglecting CPU cycles
+*/
+class HostClock
+{
+    public:
+
+    /**
+    @brief Get the modeled time
+    @result Time in ns
+    */
+    static uint64_t now()
+    {
+        return s_ns;
+    }
+
+    /**
+    @brief Advance the modeled time
+    @param ns Time in ns
+    */
+    static void advance(const uint64_t ns)
+    {
+        s_ns += ns;
+    }
+
+    private:
+
+    static inline uint64_t s_ns = 0;
+};
+
+#endif
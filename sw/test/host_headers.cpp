@@ -0,0 +1,279 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Compile check: All driver headers have to be self-contained, apart from <avr/io.h>, and warning-free on the host.
+// Each class template is instantiated explicitly with mock backends, so all of its members are compiled even if host_test does not use them.
+// Member templates and members of 8 bit port expanders (where readA()/readB() must not be instantiated) are instantiated by instantiateMemberTemplates(), which is never called
+
+#include "25LC512.h"
+#include "25LC512_cache.h"
+#include "25LC512_log.h"
+#include "25LC512_write_queue.h"
+#include "74HC595.h"
+#include "DSPIC33.h"
+#include "DSPIC33_parameters.h"
+#include "HD44780.h"
+#include "HD44780_async.h"
+#include "HD44780_framebuffer.h"
+#include "HD44780_glyphs.h"
+#include "HD44780_stream.h"
+#include "MCP23008.h"
+#include "MCP23017.h"
+#include "MCP23S08.h"
+#include "MCP23S17.h"
+#include "MCP23XXX.h"
+#include "MCP23xxx_transport.h"
+#include "analog_multiplexer.h"
+#include "analog_multiplexer_cascade.h"
+#include "analog_multiplexer_scanner.h"
+#include "line_decoder.h"
+#include "line_encoder.h"
+#include "matrix_scanner.h"
+#include "ring_buffer.h"
+#include "shift_register.h"
+#include "shift_register_async.h"
+#include "shift_register_image.h"
+#include "spi_bus.h"
+#include "spi_instrumentation.h"
+#include "host_spi.h"
+#include "host_twi.h"
+
+typedef HostSPIMaster<> CheckSPIMaster;
+typedef HostTWIMaster<> CheckTWIMaster;
+
+// GP I/O pin, providing the method names of both GPIO libraries used by the drivers
+struct CheckPin
+{
+    static void init() {}
+    static void high() {}
+    static void low() {}
+    static void write(const bool) {}
+    static bool read() { return false; }
+    static void set_as_output() {}
+    static void set_as_input() {}
+};
+
+// GP I/O port with 3 pins
+struct CheckPort
+{
+    static constexpr uint8_t getNofPins() { return 3; }
+    static void setAsOutput() {}
+    static void setAsInput() {}
+    static void set_as_output() {}
+    static void set_as_input() {}
+    static void write(const uint8_t) {}
+    static uint8_t read() { return 0; }
+};
+
+struct CheckADC
+{
+    static constexpr uint8_t getPrescaler() { return 128; }
+    static void startConversion() {}
+    static uint16_t getResult() { return 0; }
+};
+
+struct CheckOneShotTimer
+{
+    static constexpr uint16_t getPrescaler() { return 64; }
+    static void start(const uint16_t) {}
+    static void stop() {}
+};
+
+struct CheckTickSource
+{
+    static uint16_t now() { return 0; }
+};
+
+struct CheckOutput
+{
+    static void putc(const char) {}
+};
+
+static void checkSwitch() {}
+static void checkToggle(const bool) {}
+
+// EEPROM
+typedef _25LC512<CheckSPIMaster, CheckPin> CheckEEPROM;
+template class _25LC512<CheckSPIMaster, CheckPin>;
+template class _25LC512_Cache<CheckEEPROM, 2>;
+template class _25LC512_Log<CheckEEPROM, 0x8000, 8>;
+template class _25LC512_WriteQueue<CheckEEPROM, 4>;
+
+// Shift registers
+typedef ShiftRegisterAsync<CheckSPIMaster, CheckPin, 2> CheckShiftRegisterAsync;
+template class _74HC595<CheckSPIMaster, CheckPin, 1>;
+template class _74HC595<CheckSPIMaster, CheckPin, 2>;
+template class ShiftRegister<CheckSPIMaster, CheckPin, 1>;
+template class ShiftRegister<CheckSPIMaster, CheckPin, 2>;
+template class ShiftRegisterAsync<CheckSPIMaster, CheckPin, 2>;
+template class ShiftRegisterImage<_74HC595<CheckSPIMaster, CheckPin, 2>>;
+template class ShiftRegisterImage<CheckShiftRegisterAsync>;
+
+// DSP
+typedef DSPIC33<CheckSPIMaster, CheckPin> CheckDSP;
+template class DSPIC33<CheckSPIMaster, CheckPin>;
+template class DSPIC33_ParameterTable<CheckDSP, 40, 4>;
+
+// LCD. Base classes are not instantiated by explicit instantiation of derived classes, so the ports are instantiated separately
+typedef HD44780_ParallelPort<CheckPort, CheckPin, CheckPin> CheckParallelPort;
+typedef HD44780_ParallelPort<CheckPort, CheckPin, CheckPin, CheckPin, CheckPin> CheckParallelPortRW;
+typedef HD44780_74HC595_Port<CheckSPIMaster, CheckPin> Check74HC595Port;
+typedef HD44780<HD44780_NofCharacters::_2x16, Check74HC595Port> CheckDisplay;
+template class HD44780_ParallelPort<CheckPort, CheckPin, CheckPin>;
+template class HD44780_ParallelPort<CheckPort, CheckPin, CheckPin, CheckPin, CheckPin>;
+template class HD44780_74HC595_Port<CheckSPIMaster, CheckPin>;
+template class HD44780<HD44780_NofCharacters::_2x16, Check74HC595Port>;
+template class HD44780_Async<HD44780_NofCharacters::_4x20, Check74HC595Port, 100>;
+template class HD44780_Framebuffer<CheckDisplay>;
+template class HD44780_GlyphAnimation<CheckDisplay>;
+template class HD44780_Stream<CheckOutput>;
+
+// Port expanders. Each pin type and callback policy is used once
+typedef MCP23xxxDeferredCallback<CheckTickSource, 4> CheckDeferredCallback;
+typedef MCP23S17Addressed<CheckSPIMaster, CheckPin, 1,
+    MCP23S17PinConfig<MCP23S17PinIdx::A0, MCP23xxxPinType::OUTPUT>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A1, MCP23xxxPinType::INPUT>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A2, MCP23xxxPinType::INPUT_PU>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A3, MCP23xxxPinType::SWITCH>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A4, MCP23xxxPinType::SWITCH_TOGGLE, MCP23xxxStaticCallback<checkToggle>>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A5, MCP23xxxPinType::ROTENC_PHASE_A, CheckDeferredCallback>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A6, MCP23xxxPinType::ROTENC_PHASE_B>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B0, MCP23xxxPinType::SWITCH_DEBOUNCED, MCP23xxxStaticCallback<checkSwitch>>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B1, MCP23xxxPinType::SWITCH_TOGGLE_DEBOUNCED, CheckDeferredCallback>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B2, MCP23xxxPinType::ROTENC_QUAD_X1_A>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B3, MCP23xxxPinType::ROTENC_QUAD_B>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B4, MCP23xxxPinType::ROTENC_QUAD_X2_A, MCP23xxxStaticCallback<checkToggle>>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B5, MCP23xxxPinType::ROTENC_QUAD_B>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B6, MCP23xxxPinType::ROTENC_QUAD_X4_A, CheckDeferredCallback>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B7, MCP23xxxPinType::ROTENC_QUAD_B>> CheckMCP23S17;
+typedef MCP23S17Addressed<CheckSPIMaster, CheckPin, 2,
+    MCP23S17PinConfig<MCP23S17PinIdx::B0, MCP23xxxPinType::OUTPUT>> CheckMCP23S17Output;
+typedef MCP23xxxDevice<MCP23xxxI2CTransport<CheckTWIMaster, 7>, MCP23xxxPort8,
+    MCP23x08PinConfig<MCP23x08PinIdx::GP0, MCP23xxxPinType::OUTPUT>,
+    MCP23x08PinConfig<MCP23x08PinIdx::GP1, MCP23xxxPinType::SWITCH_TOGGLE_DEBOUNCED, CheckDeferredCallback>,
+    MCP23x08PinConfig<MCP23x08PinIdx::GP2, MCP23xxxPinType::ROTENC_QUAD_X4_A>,
+    MCP23x08PinConfig<MCP23x08PinIdx::GP3, MCP23xxxPinType::ROTENC_QUAD_B>> CheckMCP23008Device;
+typedef MCP23xxxDevice<MCP23xxxSPITransport<CheckSPIMaster, CheckPin, MCP23XXX_NO_HARDWARE_ADDRESS>, MCP23xxxPort8,
+    MCP23x08PinConfig<MCP23x08PinIdx::GP7, MCP23xxxPinType::SWITCH>> CheckMCP23S08Device;
+template class MCP23xxxDeferredCallback<CheckTickSource, 4>;
+template class MCP23xxxSPITransport<CheckSPIMaster, CheckPin, 1>;
+template class MCP23xxxSPITransport<CheckSPIMaster, CheckPin, MCP23XXX_NO_HARDWARE_ADDRESS>;
+template class MCP23xxxI2CTransport<CheckTWIMaster, 7>;
+template class MCP23xxxDevice<MCP23xxxSPITransport<CheckSPIMaster, CheckPin, 1>, MCP23xxxPort16,
+    MCP23S17PinConfig<MCP23S17PinIdx::A0, MCP23xxxPinType::OUTPUT>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A1, MCP23xxxPinType::INPUT>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A2, MCP23xxxPinType::INPUT_PU>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A3, MCP23xxxPinType::SWITCH>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A4, MCP23xxxPinType::SWITCH_TOGGLE, MCP23xxxStaticCallback<checkToggle>>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A5, MCP23xxxPinType::ROTENC_PHASE_A, CheckDeferredCallback>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A6, MCP23xxxPinType::ROTENC_PHASE_B>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B0, MCP23xxxPinType::SWITCH_DEBOUNCED, MCP23xxxStaticCallback<checkSwitch>>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B1, MCP23xxxPinType::SWITCH_TOGGLE_DEBOUNCED, CheckDeferredCallback>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B2, MCP23xxxPinType::ROTENC_QUAD_X1_A>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B3, MCP23xxxPinType::ROTENC_QUAD_B>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B4, MCP23xxxPinType::ROTENC_QUAD_X2_A, MCP23xxxStaticCallback<checkToggle>>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B5, MCP23xxxPinType::ROTENC_QUAD_B>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B6, MCP23xxxPinType::ROTENC_QUAD_X4_A, CheckDeferredCallback>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B7, MCP23xxxPinType::ROTENC_QUAD_B>>;
+template class MCP23xxxDevice<MCP23xxxI2CTransport<CheckTWIMaster, 7>, MCP23xxxPort16,
+    MCP23S17PinConfig<MCP23S17PinIdx::A7, MCP23xxxPinType::SWITCH_TOGGLE>>;
+template class MCP23S17Bus<CheckMCP23S17, CheckMCP23S17Output>;
+
+// Multiplexers, line decoders and key matrices
+typedef AnalogMultiplexerCascade<LineDecoder<CheckPort>, AnalogMultiplexer<CheckPort>> CheckCascade;
+template class AnalogMultiplexer<CheckPort>;
+template class AnalogMultiplexerCascade<LineDecoder<CheckPort>, AnalogMultiplexer<CheckPort>>;
+template class AnalogMultiplexerGrayCodeOrder<64, 0x8000000000000001ULL>;
+template class AnalogMultiplexerScanner<AnalogMultiplexer<CheckPort>, CheckADC, AnalogMultiplexerNoTimer>;
+template class AnalogMultiplexerScanner<CheckCascade, CheckADC, CheckOneShotTimer, 4, AnalogMultiplexerSettling<1>, AnalogMultiplexerGrayCodeOrder<64, 0x8000000000000001ULL>>;
+template class LineDecoder<CheckPort>;
+template class LineEncoder<CheckPort>;
+template class MatrixScanner<LineDecoder<CheckPort>, CheckPort>;
+template class MatrixScanner<LineDecoder<CheckPort>, LineEncoder<CheckPort>, true, 4>;
+template class RingBuffer<uint8_t, 1>;
+template class RingBuffer<uint16_t, 128>;
+
+// SPI bus
+typedef SPIStatistics<CheckTickSource, 1, 16> CheckStatistics;
+template class SPIDevicePin<CheckPin, _25LC512_MAX_SPI_CLOCK, 3>;
+template class SPIBus<AVRSPIConfig, 3, 4>;
+template class SPIStatistics<CheckTickSource, 1, 16>;
+template class SPIInstrumentedPin<CheckPin, SPINoStatistics>;
+template class SPIInstrumentedPin<SPIDevicePin<CheckPin, _25LC512_MAX_SPI_CLOCK>, CheckStatistics>;
+template class SPIInstrumentedMaster<CheckSPIMaster, SPINoStatistics>;
+template class SPIInstrumentedMaster<CheckSPIMaster, CheckStatistics>;
+
+// LCD on parallel ports, which have no backlight pin (setBacklight() must not be instantiated)
+typedef HD44780<HD44780_NofCharacters::_1x16, CheckParallelPort> CheckParallelDisplay;
+typedef HD44780<HD44780_NofCharacters::_4x40, CheckParallelPortRW> CheckParallelDisplay4x40;
+template void CheckParallelDisplay::init();
+template void CheckParallelDisplay::clear();
+template void CheckParallelDisplay::home();
+template void CheckParallelDisplay::setCursor(uint8_t, uint8_t);
+template void CheckParallelDisplay::putc(char);
+template void CheckParallelDisplay::puts(const char *);
+template void CheckParallelDisplay::putsP(const char *);
+template void CheckParallelDisplay::generateChar(uint8_t, const uint8_t *);
+template void CheckParallelDisplay::generateChar_P(uint8_t, const uint8_t *);
+template void CheckParallelDisplay::loadCharSet_P(const uint8_t *, uint8_t);
+template void CheckParallelDisplay::setCGRAMAddress(uint8_t);
+template void CheckParallelDisplay4x40::init();
+template void CheckParallelDisplay4x40::clear();
+template void CheckParallelDisplay4x40::setCursor(uint8_t, uint8_t);
+template void CheckParallelDisplay4x40::putc(char);
+template void CheckParallelDisplay4x40::loadCharSet_P(const uint8_t *, uint8_t);
+
+// 8 bit port expanders
+template void CheckMCP23008Device::init(bool, bool);
+template void CheckMCP23008Device::onInterrupt();
+template void CheckMCP23008Device::tick();
+template void CheckMCP23008Device::reArmInterrupt();
+template uint16_t CheckMCP23008Device::read();
+template void CheckMCP23008Device::writePort(uint16_t, uint16_t);
+template uint16_t CheckMCP23008Device::getOutputLatches();
+template void CheckMCP23S08Device::init(bool, bool);
+template void CheckMCP23S08Device::onInterrupt();
+
+[[maybe_unused]] static void instantiateMemberTemplates()
+{
+    uint8_t data[4] = {};
+    const uint8_t nofBytes = sizeof(data);
+
+    CheckEEPROM::write(0, data, nofBytes);
+    CheckEEPROM::read(0, data, nofBytes);
+    _25LC512_Cache<CheckEEPROM, 2>::write(0, data, nofBytes);
+    _25LC512_Cache<CheckEEPROM, 2>::read(0, data, nofBytes);
+    _25LC512_WriteQueue<CheckEEPROM, 4>::write(0, data, static_cast<uint16_t>(nofBytes));
+    _25LC512_WriteQueue<CheckEEPROM, 4>::write(0, data, nofBytes, []() {});
+    _25LC512_Log<CheckEEPROM, 0x8000, 8>::replay([](uint32_t, const uint8_t *, uint8_t) {});
+
+    CheckStatistics::dump<CheckOutput>();
+
+    CheckMCP23S17::Pin<MCP23S17PinIdx::A0>::high();
+    CheckMCP23S17::Pin<MCP23S17PinIdx::A0>::low();
+    CheckMCP23S17::Pin<MCP23S17PinIdx::A0>::write(true);
+    CheckMCP23S17::Pin<MCP23S17PinIdx::A6>::read();
+    CheckMCP23S17::Pin<MCP23S17PinIdx::A3>::registerCallback([]() {});
+    CheckMCP23S17::Pin<MCP23S17PinIdx::B2>::registerCallback([](bool) {});
+    CheckMCP23008Device::Pin<MCP23x08PinIdx::GP0>::high();
+    CheckMCP23008Device::Pin<MCP23x08PinIdx::GP2>::registerCallback([](bool) {});
+    CheckMCP23S08Device::Pin<MCP23x08PinIdx::GP7>::registerCallback([]() {});
+    MCP23008<CheckTWIMaster, 3, MCP23x08PinConfig<MCP23x08PinIdx::GP4, MCP23xxxPinType::INPUT>>::read();
+    MCP23017<CheckTWIMaster, 4, MCP23S17PinConfig<MCP23S17PinIdx::B4, MCP23xxxPinType::INPUT>>::readB();
+    MCP23S08<CheckSPIMaster, CheckPin, MCP23x08PinConfig<MCP23x08PinIdx::GP4, MCP23xxxPinType::INPUT>>::read();
+    MCP23S08Addressed<CheckSPIMaster, CheckPin, 3, MCP23x08PinConfig<MCP23x08PinIdx::GP4, MCP23xxxPinType::INPUT>>::read();
+}
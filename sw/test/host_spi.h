@@ -0,0 +1,204 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "host_clock.h"
+
+/**
+@brief Interface of emulated SPI devices
+*/
+class HostSPIDevice
+{
+    public:
+
+    /// @brief Called on the falling edge of the SS pin
+    virtual void select() {}
+
+    /// @brief Called on the rising edge of the SS pin
+    virtual void deselect() {}
+
+    /**
+    @brief Exchange one byte
+    @param mosi Byte sent by the master
+    @result Byte sent by the device
+    */
+    virtual uint8_t transfer(const uint8_t mosi) = 0;
+
+    protected:
+
+    ~HostSPIDevice() = default;
+};
+
+/**
+@brief Emulated SPI bus recording the traffic of all devices
+Bytes are routed to the device whose SS pin is low. Bytes without selected device and overlapping selections are counted as errors
+*/
+class HostSPIBus
+{
+    public:
+
+    static void select(HostSPIDevice & device)
+    {
+        if (s_device != nullptr)
+        {
+            ++s_nofErrors;
+        }
+        s_device = &device;
+        ++s_nofSelects;
+        device.select();
+    }
+
+    static void deselect(HostSPIDevice & device)
+    {
+        if (s_device == &device)
+        {
+            s_device = nullptr;
+            device.deselect();
+        }
+    }
+
+    static uint8_t transfer(const uint8_t mosi)
+    {
+        ++s_nofBytes;
+        if (s_device == nullptr)
+        {
+            ++s_nofErrors;
+            return 0xFF;
+        }
+        return s_device->transfer(mosi);
+    }
+
+    /// @brief Reset all counters
+    static void reset()
+    {
+        s_nofBytes = 0;
+        s_nofSelects = 0;
+        s_nofErrors = 0;
+    }
+
+    /**
+    @brief Get the number of bytes on the wire since the last reset
+    @result Number of bytes
+    */
+    static uint32_t getNofBytes()
+    {
+        return s_nofBytes;
+    }
+
+    /**
+    @brief Get the number of SS cycles since the last reset
+    @result Number of falling edges of any SS pin
+    */
+    static uint32_t getNofSelects()
+    {
+        return s_nofSelects;
+    }
+
+    /**
+    @brief Get the number of protocol errors since the last reset
+    @result Number of bytes without selected device and overlapping selections
+    */
+    static uint32_t getNofErrors()
+    {
+        return s_nofErrors;
+    }
+
+    private:
+
+    static inline HostSPIDevice * s_device = nullptr;
+    static inline uint32_t s_nofBytes = 0;
+    static inline uint32_t s_nofSelects = 0;
+    static inline uint32_t s_nofErrors = 0;
+};
+
+/**
+@brief Mock SPI master driver class
+Implements the blocking and asynchronous SPI master interfaces used by the drivers. Each byte advances HostClock by 8 SPI clock cycles
+@tparam t_clock SPI clock in Hz
+*/
+template <uint32_t t_clock = 8000000UL>
+class HostSPIMaster
+{
+    public:
+
+    static void init() {}
+
+    static void put(const uint8_t data)
+    {
+        transfer(data);
+    }
+
+    static void put(const uint8_t * const data, const uint16_t nofBytes)
+    {
+        for (uint16_t idx = 0; idx < nofBytes; ++idx)
+        {
+            transfer(data[idx]);
+        }
+    }
+
+    static uint8_t get()
+    {
+        return transfer(0xFF);
+    }
+
+    static void get(uint8_t * const data, const uint16_t nofBytes)
+    {
+        for (uint16_t idx = 0; idx < nofBytes; ++idx)
+        {
+            data[idx] = transfer(0xFF);
+        }
+    }
+
+    static uint8_t transfer(const uint8_t data)
+    {
+        HostClock::advance(8000000000ULL / t_clock);
+        return HostSPIBus::transfer(data);
+    }
+
+    static void startTransfer(const uint8_t data)
+    {
+        transfer(data);
+    }
+};
+
+/**
+@brief Mock SS pin connected to an emulated device
+@tparam t_device Emulated device, i.e. an object derived from HostSPIDevice
+*/
+template <auto & t_device>
+class HostSSPin
+{
+    public:
+
+    static void init() {}
+
+    static void low()
+    {
+        HostSPIBus::select(t_device);
+    }
+
+    static void high()
+    {
+        HostSPIBus::deselect(t_device);
+    }
+};
+
+#endif
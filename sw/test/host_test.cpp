@@ -0,0 +1,1100 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Functional tests of the drivers against emulated devices
+
+#include <stdio.h>
+#include <string.h>
+#include "host_spi.h"
+#include "host_25LC512.h"
+#include "host_MCP23xxx.h"
+#include "host_HD44780.h"
+#include "host_74HC595.h"
+#include "host_DSPIC33.h"
+#include "host_twi.h"
+#include "25LC512.h"
+#include "25LC512_cache.h"
+#include "25LC512_log.h"
+#include "25LC512_write_queue.h"
+#include "DSPIC33.h"
+#include "DSPIC33_parameters.h"
+#include "MCP23008.h"
+#include "MCP23017.h"
+#include "MCP23S08.h"
+#include "MCP23S17.h"
+#include "HD44780.h"
+#include "HD44780_async.h"
+#include "HD44780_glyphs.h"
+#include "HD44780_stream.h"
+#include "line_decoder.h"
+#include "matrix_scanner.h"
+#include "ring_buffer.h"
+#include "shift_register_async.h"
+#include "shift_register_image.h"
+#include "analog_multiplexer.h"
+#include "analog_multiplexer_scanner.h"
+#include "spi_bus.h"
+#include "spi_instrumentation.h"
+
+static uint32_t s_nofFailures = 0;
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+static void check(const bool condition, const char * expression, const char * file, const int line)
+{
+    if (!condition)
+    {
+        printf("%s:%d: check failed: %s\n", file, line, expression);
+        ++s_nofFailures;
+    }
+}
+
+typedef HostSPIMaster<> SPIMaster;
+typedef HostTWIMaster<> TWIMaster;
+
+// Text output collecting the characters of one line
+static char s_text[80];
+static uint8_t s_textLength = 0;
+
+struct HostTextOutput
+{
+    static void putc(const char data)
+    {
+        if (s_textLength + 1u < sizeof(s_text))
+        {
+            s_text[s_textLength++] = data;
+            s_text[s_textLength] = '\0';
+        }
+    }
+};
+
+// Get the collected text. The next character starts a new one
+static const char * takeText()
+{
+    s_textLength = 0;
+    return s_text;
+}
+
+// Ring buffer
+
+static void testRingBuffer()
+{
+    RingBuffer<uint8_t, 4> buffer;
+    for (uint8_t value = 1; value <= 4; ++value)
+    {
+        CHECK(buffer.push(value));
+    }
+    CHECK(buffer.full() && !buffer.push(5));
+
+    buffer.pop();
+    buffer.back() = 5;
+    buffer.commit();
+    CHECK(buffer.size() == 4);
+
+    uint16_t sum = 0;
+    while (!buffer.empty())
+    {
+        sum = sum * 10 + buffer.front();
+        buffer.pop();
+    }
+    CHECK(sum == 2345);
+}
+
+// EEPROM
+
+static Host25LC512 s_eeprom;
+typedef _25LC512<SPIMaster, HostSSPin<s_eeprom>> EEPROM;
+
+static void testEEPROMWriteRead()
+{
+    uint8_t data[300];
+    for (uint16_t idx = 0; idx < sizeof(data); ++idx)
+    {
+        data[idx] = idx * 7;
+    }
+
+    // 28 + 128 + 128 + 16 bytes
+    const uint32_t nofCycles = s_eeprom.getNofCycles();
+    EEPROM::write(100, data, sizeof(data));
+    CHECK(s_eeprom.getNofCycles() - nofCycles == 4);
+
+    uint8_t buffer[sizeof(data)];
+    EEPROM::read(100, buffer, sizeof(buffer));
+    CHECK(memcmp(data, buffer, sizeof(data)) == 0);
+    CHECK(s_eeprom.getMemory()[99] == 0xFF && s_eeprom.getMemory()[400] == 0xFF);
+
+    EEPROM::erase(128, static_cast<uint16_t>(256));
+    EEPROM::waitWhileBusy();
+    CHECK(EEPROM::read(127) == data[27] && EEPROM::read(128) == 0xFF && EEPROM::read(383) == 0xFF && EEPROM::read(384) == data[284]);
+}
+
+static void testLogRecovery()
+{
+    typedef _25LC512_Log<EEPROM, 0x8000, 8> Log;
+    const auto countRecords = []()
+    {
+        uint8_t nofRecords = 0;
+        Log::replay([&nofRecords](Log::Sequence, const uint8_t *, uint8_t) { ++nofRecords; });
+        return nofRecords;
+    };
+
+    Log::format();
+    for (uint8_t idx = 0; idx < 16; ++idx)
+    {
+        CHECK(Log::append(&idx, 1));
+    }
+    EEPROM::waitWhileBusy();
+
+    // Record layout is the same on all targets: Sequence number 8 (little endian), length 1, checksum, payload
+    const uint8_t record[] = {8, 0, 0, 0, 1, 8 + 1 + 8, 8};
+    CHECK(memcmp(s_eeprom.getMemory() + 0x8000, record, sizeof(record)) == 0);
+    CHECK(Log::maxRecordSize() == EEPROM::pageSize() - 6);
+
+    Log::init();
+    CHECK(Log::getNextSequence() == 16);
+    CHECK(countRecords() == 8);
+
+    // Torn append of the first record of a new lap
+    memset(s_eeprom.getMemory() + 0x8000, 0xFF, EEPROM::pageSize());
+    Log::init();
+    CHECK(!Log::isEmpty());
+    CHECK(Log::getNextSequence() == 16);
+    CHECK(countRecords() == 7);
+
+    // Torn header of page 0
+    s_eeprom.getMemory()[0x8000] = 0;
+    Log::init();
+    CHECK(Log::getNextSequence() == 16);
+}
+
+static void testEEPROMWriteQueue()
+{
+    typedef _25LC512_WriteQueue<EEPROM, 4> WriteQueue;
+
+    uint8_t data[200];
+    for (uint8_t idx = 0; idx < sizeof(data); ++idx)
+    {
+        data[idx] = idx * 3;
+    }
+
+    // 64 + 128 + 8 bytes. A request not fitting into the queue is rejected as a whole
+    bool done = false;
+    CHECK(WriteQueue::write(0x1040, data, sizeof(data), [&done]() { done = true; }));
+    CHECK(WriteQueue::available() == 1);
+    CHECK(!WriteQueue::write(0x2000, data, static_cast<uint16_t>(256)));
+    CHECK(WriteQueue::available() == 1);
+
+    // Each tick either polls the WIP bit or programs one page, so the ticks span the write cycles of all pages
+    const uint32_t nofCycles = s_eeprom.getNofCycles();
+    uint8_t nofTicks = 0;
+    while (!WriteQueue::isIdle() && nofTicks < 100)
+    {
+        WriteQueue::tick();
+        HostClock::advance(1000000);
+        ++nofTicks;
+    }
+    CHECK(done && WriteQueue::isIdle());
+    CHECK(s_eeprom.getNofCycles() - nofCycles == 3);
+    CHECK(nofTicks >= 3 * 5);
+    CHECK(memcmp(s_eeprom.getMemory() + 0x1040, data, sizeof(data)) == 0);
+}
+
+static void testEEPROMCache()
+{
+    typedef _25LC512_Cache<EEPROM, 2> Cache;
+
+    memset(s_eeprom.getMemory() + 0x3000, 0x55, 3 * EEPROM::pageSize());
+    Cache::invalidate();
+
+    // Lines hold pages 0x3000 and 0x3080. Writes are collected in RAM
+    const uint32_t nofCycles = s_eeprom.getNofCycles();
+    CHECK(Cache::read(0x3001) == 0x55);
+    Cache::write(0x3010, 0xAA);
+    Cache::write(0x3011, 0x55);
+    Cache::write(0x3012, 0xBB);
+    Cache::write(0x3080, 0xCC);
+    CHECK(Cache::isDirty());
+    CHECK(s_eeprom.getNofCycles() == nofCycles);
+
+    // Page 0x3000 is the least recently used line. It is written back by one page write on the miss
+    CHECK(Cache::read(0x3100) == 0x55);
+    CHECK(s_eeprom.getNofCycles() - nofCycles == 1);
+    const uint8_t written[] = {0xAA, 0x55, 0xBB};
+    CHECK(memcmp(s_eeprom.getMemory() + 0x3010, written, sizeof(written)) == 0);
+    CHECK(s_eeprom.getMemory()[0x3080] == 0x55);
+
+    Cache::flush();
+    CHECK(!Cache::isDirty());
+    CHECK(s_eeprom.getNofCycles() - nofCycles == 2);
+    CHECK(s_eeprom.getMemory()[0x3080] == 0xCC);
+    EEPROM::waitWhileBusy();
+}
+
+// Port expander
+
+static HostMCP23S17 s_expander;
+static uint8_t s_nofPresses = 0;
+
+static void onPress()
+{
+    ++s_nofPresses;
+}
+
+typedef MCP23S17<SPIMaster, HostSSPin<s_expander>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A0, MCP23xxxPinType::OUTPUT>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B7, MCP23xxxPinType::OUTPUT>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B0, MCP23xxxPinType::SWITCH, MCP23xxxStaticCallback<onPress>>> Expander;
+
+static void testExpander()
+{
+    Expander::init();
+    CHECK(s_expander.getRegisterPair(0x00) == 0x0001); // IODIR, unused pins are outputs
+    CHECK(s_expander.getRegisterPair(0x04) == 0x0001); // GPINTEN
+    CHECK(s_expander.getRegisterPair(0x0C) == 0x0001); // GPPU
+
+    Expander::Pin<MCP23S17PinIdx::A0>::high();
+    CHECK(s_expander.getOutputs() == 0x0100);
+
+    Expander::writePort(0x0180, 0x0080);
+    CHECK(s_expander.getOutputs() == 0x0080);
+    CHECK(Expander::getOutputLatches() == 0x0080);
+
+    // Press and release switch B0 (active low)
+    s_expander.setInputs(0xFFFE);
+    CHECK(s_expander.hasInterrupt());
+    Expander::onInterrupt();
+    CHECK(!s_expander.hasInterrupt());
+    s_expander.setInputs(0xFFFF);
+    Expander::onInterrupt();
+    CHECK(s_nofPresses == 1);
+}
+
+// Debounced switch
+
+static HostMCP23S17 s_switchExpander;
+static bool s_switchPressed = false;
+static uint8_t s_nofToggles = 0;
+
+static void onToggle(const bool pressed)
+{
+    s_switchPressed = pressed;
+    ++s_nofToggles;
+}
+
+typedef MCP23S17<SPIMaster, HostSSPin<s_switchExpander>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B1, MCP23xxxPinType::SWITCH_TOGGLE_DEBOUNCED, MCP23xxxStaticCallback<onToggle>>> SwitchExpander;
+
+static void testDebouncedSwitch()
+{
+    SwitchExpander::init();
+    s_switchExpander.setInputs(0xFFFF);
+
+    // Press and bounce back before the interrupt is handled. The bounce raises no new interrupt, INTCAP still holds the pressed state
+    s_switchExpander.setInputs(0xFFFD);
+    s_switchExpander.setInputs(0xFFFF);
+    SwitchExpander::onInterrupt();
+    CHECK(s_switchPressed && s_nofToggles == 1);
+
+    // The port value read by the interrupt is reported at the end of the lockout
+    for (uint8_t tick = 0; tick < MCP23XXX_DEBOUNCE_TICKS; ++tick)
+    {
+        SwitchExpander::tick();
+    }
+    CHECK(!s_switchPressed && s_nofToggles == 2);
+    for (uint8_t tick = 0; tick < MCP23XXX_DEBOUNCE_TICKS; ++tick)
+    {
+        SwitchExpander::tick();
+    }
+
+    // Bouncing within the lockout ends on the pressed level
+    s_switchExpander.setInputs(0xFFFD);
+    SwitchExpander::onInterrupt();
+    s_switchExpander.setInputs(0xFFFF);
+    SwitchExpander::onInterrupt();
+    s_switchExpander.setInputs(0xFFFD);
+    SwitchExpander::onInterrupt();
+    CHECK(s_switchPressed && s_nofToggles == 3);
+    for (uint8_t tick = 0; tick < MCP23XXX_DEBOUNCE_TICKS; ++tick)
+    {
+        SwitchExpander::tick();
+    }
+    CHECK(s_switchPressed && s_nofToggles == 3);
+}
+
+// Two addressed expanders sharing one SS pin
+class HostSharedSS : public HostSPIDevice
+{
+    public:
+
+    HostSharedSS(HostSPIDevice & first, HostSPIDevice & second)
+    : m_first(first), m_second(second)
+    {}
+
+    void select() override
+    {
+        m_first.select();
+        m_second.select();
+    }
+
+    void deselect() override
+    {
+        m_first.deselect();
+        m_second.deselect();
+    }
+
+    uint8_t transfer(const uint8_t mosi) override
+    {
+        // Devices not addressed keep MISO high
+        return m_first.transfer(mosi) & m_second.transfer(mosi);
+    }
+
+    private:
+
+    HostSPIDevice & m_first;
+    HostSPIDevice & m_second;
+};
+
+static HostMCP23S17 s_expander1(1);
+static HostMCP23S17 s_expander2(2);
+static HostSharedSS s_sharedSS(s_expander1, s_expander2);
+
+struct HostTickSource
+{
+    static uint16_t now()
+    {
+        return HostClock::now() / 1000;
+    }
+};
+
+// Switch events of both expanders share one queue
+typedef MCP23xxxDeferredCallback<HostTickSource, 4> DeferredCallback;
+
+typedef MCP23S17Addressed<SPIMaster, HostSSPin<s_sharedSS>, 1,
+    MCP23S17PinConfig<MCP23S17PinIdx::B1, MCP23xxxPinType::OUTPUT>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A0, MCP23xxxPinType::INPUT>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A1, MCP23xxxPinType::SWITCH, DeferredCallback>> Expander1;
+typedef MCP23S17Addressed<SPIMaster, HostSSPin<s_sharedSS>, 2,
+    MCP23S17PinConfig<MCP23S17PinIdx::A3, MCP23xxxPinType::OUTPUT>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B2, MCP23xxxPinType::INPUT>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A1, MCP23xxxPinType::SWITCH, DeferredCallback>> Expander2;
+
+static void testExpanderBus()
+{
+    MCP23S17Bus<Expander1, Expander2>::init();
+    CHECK(s_expander1.getRegisterPair(0x00) == 0x0300);
+    CHECK(s_expander2.getRegisterPair(0x00) == 0x0204);
+
+    Expander1::Pin<MCP23S17PinIdx::B1>::high();
+    Expander2::Pin<MCP23S17PinIdx::A3>::high();
+    CHECK(s_expander1.getOutputs() == 0x0002);
+    CHECK(s_expander2.getOutputs() == 0x0800);
+
+    // Switches A1 released (active low)
+    s_expander1.setInputs(0x0300);
+    s_expander2.setInputs(0x0204);
+    uint16_t values[2];
+    MCP23S17Bus<Expander1, Expander2>::read(values);
+    CHECK(values[0] == 0x0102 && values[1] == 0x0804);
+    MCP23S17Bus<Expander1, Expander2>::onInterrupt();
+
+    // Press switch A1 of the second expander
+    s_expander2.setInputs(0x0004);
+    MCP23S17Bus<Expander1, Expander2>::onInterrupt();
+    DeferredCallback::Event event;
+    CHECK(DeferredCallback::pop(event));
+    CHECK(event.hardwareAddress == 2 && event.pinIdx == static_cast<uint8_t>(MCP23S17PinIdx::A1) && event.value);
+    CHECK(!DeferredCallback::pop(event));
+}
+
+// 8 bit port expander with hardware addressing
+
+static HostMCP23S08 s_expander8(2);
+static bool s_pressedGP5 = false;
+
+static void onToggleGP5(const bool pressed)
+{
+    s_pressedGP5 = pressed;
+}
+
+typedef MCP23S08Addressed<SPIMaster, HostSSPin<s_expander8>, 2,
+    MCP23x08PinConfig<MCP23x08PinIdx::GP0, MCP23xxxPinType::OUTPUT>,
+    MCP23x08PinConfig<MCP23x08PinIdx::GP5, MCP23xxxPinType::SWITCH_TOGGLE, MCP23xxxStaticCallback<onToggleGP5>>> Expander8;
+
+static void testExpander8()
+{
+    Expander8::init();
+    CHECK(s_expander8.getRegister(0x00) == 0x20); // IODIR
+    CHECK(s_expander8.getRegister(0x05) & 0x08); // IOCON.HAEN
+
+    Expander8::Pin<MCP23x08PinIdx::GP0>::high();
+    CHECK(s_expander8.getOutputs() == 0x01);
+
+    // Press and release switch GP5 (active low)
+    s_expander8.setInputs(0xDF);
+    Expander8::onInterrupt();
+    CHECK(s_pressedGP5);
+    s_expander8.setInputs(0xFF);
+    Expander8::onInterrupt();
+    CHECK(!s_pressedGP5);
+    CHECK((Expander8::read() & 0x21) == 0x01);
+}
+
+// I2C port expanders with full quadrature decoders
+
+static HostMCP23017 s_i2cExpander(3);
+static HostMCP23008 s_i2cExpander8(5);
+static int8_t s_encoderPosition = 0;
+static int8_t s_encoder8Position = 0;
+
+static void onEncoder(const bool clockwise)
+{
+    s_encoderPosition += clockwise ? 1 : -1;
+}
+
+static void onEncoder8(const bool clockwise)
+{
+    s_encoder8Position += clockwise ? 1 : -1;
+}
+
+typedef MCP23017<TWIMaster, 3,
+    MCP23S17PinConfig<MCP23S17PinIdx::A0, MCP23xxxPinType::ROTENC_QUAD_X4_A, MCP23xxxStaticCallback<onEncoder>>,
+    MCP23S17PinConfig<MCP23S17PinIdx::A1, MCP23xxxPinType::ROTENC_QUAD_B>,
+    MCP23S17PinConfig<MCP23S17PinIdx::B3, MCP23xxxPinType::OUTPUT>> I2CExpander;
+typedef MCP23008<TWIMaster, 5,
+    MCP23x08PinConfig<MCP23x08PinIdx::GP0, MCP23xxxPinType::ROTENC_QUAD_X1_A, MCP23xxxStaticCallback<onEncoder8>>,
+    MCP23x08PinConfig<MCP23x08PinIdx::GP1, MCP23xxxPinType::ROTENC_QUAD_B>,
+    MCP23x08PinConfig<MCP23x08PinIdx::GP7, MCP23xxxPinType::OUTPUT>> I2CExpander8;
+
+// Rotate an encoder by one detent. Both phases are active low, phase B is connected to the pin following phase A
+static void rotate(auto & expander, void (* const onInterrupt)(), const uint16_t phaseA, const bool clockwise)
+{
+    const uint16_t phaseB = phaseA << 1;
+    const uint16_t sequence[] = {clockwise ? phaseA : phaseB, static_cast<uint16_t>(phaseA | phaseB), clockwise ? phaseB : phaseA, 0};
+    for (const uint16_t active : sequence)
+    {
+        expander.setInputs(~active);
+        onInterrupt();
+    }
+}
+
+static void testI2CExpanders()
+{
+    HostTWIBus::attach(s_i2cExpander);
+    HostTWIBus::attach(s_i2cExpander8);
+
+    I2CExpander::init();
+    I2CExpander8::init();
+    CHECK(s_i2cExpander.getRegisterPair(0x00) == 0x0300); // IODIR
+    CHECK(s_i2cExpander.getRegisterPair(0x04) == 0x0300); // GPINTEN
+    CHECK(s_i2cExpander8.getRegister(0x00) == 0x03);
+
+    I2CExpander::Pin<MCP23S17PinIdx::B3>::high();
+    I2CExpander8::Pin<MCP23x08PinIdx::GP7>::high();
+    CHECK(s_i2cExpander.getOutputs() == 0x0008);
+    CHECK(s_i2cExpander8.getOutputs() == 0x80);
+
+    // Each interrupt reads INTF and INTCAP of both ports: SLA+W, register address, SLA+R, 4 register values
+    const uint32_t nofBytes = HostTWIBus::getNofBytes();
+    rotate(s_i2cExpander, I2CExpander::onInterrupt, 0x0100, true);
+    CHECK(HostTWIBus::getNofBytes() - nofBytes == 4 * 7);
+    CHECK(s_encoderPosition == 4);
+    rotate(s_i2cExpander, I2CExpander::onInterrupt, 0x0100, false);
+    CHECK(s_encoderPosition == 0);
+
+    // One step per detent
+    rotate(s_i2cExpander8, I2CExpander8::onInterrupt, 0x01, true);
+    rotate(s_i2cExpander8, I2CExpander8::onInterrupt, 0x01, true);
+    rotate(s_i2cExpander8, I2CExpander8::onInterrupt, 0x01, false);
+    CHECK(s_encoder8Position == 1);
+}
+
+// LCD
+
+static HostHD44780<> s_lcd;
+typedef HD44780<HD44780_NofCharacters::_2x16, HD44780_74HC595_Port<SPIMaster, HostSSPin<s_lcd>>> Display;
+
+static void testDisplay()
+{
+    Display::init();
+    CHECK(s_lcd.isFourBitMode());
+    CHECK(s_lcd.isDisplayOn());
+
+    Display::setCursor(1, 3);
+    Display::puts("Hello");
+    char row[6] = {};
+    for (uint8_t idx = 0; idx < 5; ++idx)
+    {
+        row[idx] = s_lcd.getDDRAM(0x43 + idx);
+    }
+    CHECK(strcmp(row, "Hello") == 0);
+    CHECK(s_lcd.getNofErrors() == 0);
+}
+
+// Former 74HC595 board layout, EN on Q0
+static HostHD44780<0, 2, 4> s_lcd74HC595;
+typedef HD44780<HD44780_NofCharacters::_2x16, HD44780_Configuration_74HC595<SPIMaster, HostSSPin<s_lcd74HC595>>> Display74HC595;
+
+static void testDisplayConfiguration74HC595()
+{
+    Display74HC595::init();
+    Display74HC595::putc('A');
+    CHECK(s_lcd74HC595.isDisplayOn());
+    CHECK(s_lcd74HC595.getDDRAM(0x00) == 'A');
+    CHECK(s_lcd74HC595.getNofErrors() == 0);
+}
+
+// Tick-driven LCD
+
+static HostHD44780<> s_asyncLcd;
+typedef HD44780_Async<HD44780_NofCharacters::_2x16, HD44780_74HC595_Port<SPIMaster, HostSSPin<s_asyncLcd>>, 100> AsyncDisplay;
+
+static void testDisplayAsync()
+{
+    const uint8_t glyph[8] = {0x00, 0x0A, 0x1F, 0x1F, 0x0E, 0x04, 0x00, 0x00};
+
+    AsyncDisplay::init();
+    CHECK(AsyncDisplay::setCursor(1, 2));
+    CHECK(AsyncDisplay::puts("Async"));
+    CHECK(AsyncDisplay::generateChar(1, glyph));
+    CHECK(s_asyncLcd.getNofInstructions() == 0);
+
+    // A string not fitting into the queue is rejected as a whole
+    char text[65];
+    memset(text, 'x', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+    const uint8_t available = AsyncDisplay::available();
+    CHECK(!AsyncDisplay::puts(text));
+    CHECK(AsyncDisplay::available() == available);
+
+    // The controller must not receive an instruction before it has executed the previous one
+    uint16_t nofTicks = 0;
+    while (!AsyncDisplay::isIdle() && nofTicks < 1000)
+    {
+        HostClock::advance(100000);
+        AsyncDisplay::tick();
+        ++nofTicks;
+    }
+    CHECK(AsyncDisplay::isIdle());
+    CHECK(s_asyncLcd.isFourBitMode() && s_asyncLcd.isDisplayOn());
+
+    char row[6] = {};
+    for (uint8_t idx = 0; idx < 5; ++idx)
+    {
+        row[idx] = s_asyncLcd.getDDRAM(0x42 + idx);
+    }
+    CHECK(strcmp(row, "Async") == 0);
+    for (uint8_t idx = 0; idx < sizeof(glyph); ++idx)
+    {
+        CHECK(s_asyncLcd.getCGRAM(8 + idx) == glyph[idx]);
+    }
+    CHECK(s_asyncLcd.getNofErrors() == 0);
+}
+
+// Formatted output
+
+static void testDisplayStream()
+{
+    typedef HD44780_Stream<HostTextOutput> Stream;
+
+    Stream::putu8(7, 3);
+    CHECK(strcmp(takeText(), "  7") == 0);
+    Stream::putu32(4294967295UL);
+    CHECK(strcmp(takeText(), "4294967295") == 0);
+    Stream::puti16(-42, 5);
+    CHECK(strcmp(takeText(), "  -42") == 0);
+    Stream::puti16(-42, 5, '0');
+    CHECK(strcmp(takeText(), "-0042") == 0);
+    Stream::puti32(INT32_MIN);
+    CHECK(strcmp(takeText(), "-2147483648") == 0);
+    Stream::putFixed(static_cast<int16_t>(235), 1);
+    CHECK(strcmp(takeText(), "23.5") == 0);
+    Stream::putFixed(static_cast<int16_t>(-5), 2, 6);
+    CHECK(strcmp(takeText(), " -0.05") == 0);
+    Stream::putFixed(static_cast<int32_t>(1234567), 3);
+    CHECK(strcmp(takeText(), "1234.567") == 0);
+    Stream::putx8(0x0A);
+    Stream::putx16(0xBEEF);
+    CHECK(strcmp(takeText(), "0ABEEF") == 0);
+
+    Display::setCursor(0, 0);
+    HD44780_Stream<Display>::puti8(-128);
+    char row[5] = {};
+    for (uint8_t idx = 0; idx < 4; ++idx)
+    {
+        row[idx] = s_lcd.getDDRAM(idx);
+    }
+    CHECK(strcmp(row, "-128") == 0);
+}
+
+// Glyph animation
+
+static void testGlyphAnimation()
+{
+    typedef HD44780_GlyphAnimation<Display> Glyphs;
+
+    // After initialization, all rows are transferred by one address command and 64 data writes
+    Glyphs::init();
+    uint32_t nofInstructions = s_lcd.getNofInstructions();
+    CHECK(Glyphs::update() == 64);
+    CHECK(s_lcd.getNofInstructions() - nofInstructions == 1 + 64);
+    CHECK(Glyphs::update() == 0);
+
+    // Only changed rows are transferred, each non-contiguous row by its own address command
+    Glyphs::setRow(2, 3, 0x1F);
+    Glyphs::setRow(2, 5, 0x04);
+    Glyphs::setRow(4, 0, 0x00);
+    nofInstructions = s_lcd.getNofInstructions();
+    CHECK(Glyphs::update() == 2);
+    CHECK(s_lcd.getNofInstructions() - nofInstructions == 2 * 2);
+    CHECK(s_lcd.getCGRAM(2 * 8 + 3) == 0x1F && s_lcd.getCGRAM(2 * 8 + 4) == 0x00 && s_lcd.getCGRAM(2 * 8 + 5) == 0x04);
+    CHECK(s_lcd.getNofErrors() == 0);
+}
+
+// Shift register chain
+
+static Host74HC595<2> s_outputs;
+typedef ShiftRegisterAsync<SPIMaster, HostSSPin<s_outputs>, 2> OutputChain;
+typedef ShiftRegisterImage<OutputChain> OutputImage;
+
+static void testShiftRegisterImage()
+{
+    // Power-on transfer
+    CHECK(OutputImage::update());
+    while (!OutputChain::isDone())
+    {
+        OutputChain::onTransferComplete();
+    }
+    CHECK(s_outputs.getNofLatches() == 1);
+    CHECK(!OutputImage::update());
+
+    // Modification while the transfer is in progress does not change the frame being shifted
+    OutputImage::setBit(0);
+    CHECK(OutputImage::update());
+    OutputImage::setBit(9);
+    OutputImage::clearBit(0);
+    CHECK(!OutputImage::update());
+    while (!OutputChain::isDone())
+    {
+        OutputChain::onTransferComplete();
+    }
+    CHECK(s_outputs.getOutputs(0) == 0x01 && s_outputs.getOutputs(1) == 0x00);
+
+    CHECK(OutputImage::update());
+    while (!OutputChain::isDone())
+    {
+        OutputChain::onTransferComplete();
+    }
+    CHECK(s_outputs.getNofLatches() == 3);
+    CHECK(s_outputs.getOutputs(0) == 0x00 && s_outputs.getOutputs(1) == 0x02);
+}
+
+// Analog multiplexer scanner
+
+static uint8_t s_muxChannel = 0;
+static uint16_t s_adcResult = 0;
+static uint32_t s_nofConversions = 0;
+static uint16_t s_timerTicks = 0;
+static bool s_timerArmed = false;
+
+struct HostMuxPort
+{
+    static constexpr uint8_t getNofPins()
+    {
+        return 2;
+    }
+
+    static void setAsOutput()
+    {}
+
+    static void write(const uint8_t value)
+    {
+        s_muxChannel = value;
+    }
+};
+
+struct HostADC
+{
+    static constexpr uint8_t getPrescaler()
+    {
+        return 128;
+    }
+
+    static void startConversion()
+    {
+        ++s_nofConversions;
+    }
+
+    static uint16_t getResult()
+    {
+        return s_adcResult;
+    }
+};
+
+struct HostOneShotTimer
+{
+    static constexpr uint16_t getPrescaler()
+    {
+        return 8;
+    }
+
+    static void start(const uint16_t ticks)
+    {
+        s_timerTicks = ticks;
+        s_timerArmed = true;
+    }
+
+    static void stop()
+    {
+        s_timerArmed = false;
+    }
+};
+
+typedef AnalogMultiplexer<HostMuxPort> Mux;
+
+// Run conversions: Sample & hold takes the channel selected at that time, the timer expires before the conversion is complete
+template <typename Scanner>
+static void runScanner(const uint8_t nofFrames)
+{
+    Mux::init();
+    s_nofConversions = 0;
+    Scanner::start();
+    while (Scanner::getFrameCount() != nofFrames)
+    {
+        s_adcResult = 100 * s_muxChannel;
+        if (s_timerArmed)
+        {
+            Scanner::onSampleHoldComplete();
+        }
+        Scanner::onConversionComplete();
+    }
+    Scanner::stop();
+
+    for (uint8_t channel = 0; channel < Scanner::getNofChannels(); ++channel)
+    {
+        CHECK(Scanner::getSample(channel) == 100 * channel);
+    }
+}
+
+static void testScanner()
+{
+    // Overlapped switching, 2.5 ADC clocks = 320 CPU clocks = 40 timer clocks
+    typedef AnalogMultiplexerScanner<Mux, HostADC, HostOneShotTimer, 2> Scanner;
+    runScanner<Scanner>(2);
+    CHECK(s_timerTicks == 40);
+    CHECK(s_nofConversions == 2 * 4 * 2 + 1);
+
+    // Switching without timer discards one conversion per channel
+    typedef AnalogMultiplexerScanner<Mux, HostADC, AnalogMultiplexerNoTimer, 2> ScannerNoTimer;
+    runScanner<ScannerNoTimer>(2);
+    CHECK(s_nofConversions == 2 * 4 * 3 + 1);
+}
+
+// Key matrix
+
+static uint8_t s_keypadRow = 0;
+static uint8_t s_keypadKeys[4] = {}; // Pressed keys of each row, bit n corresponds to column n
+
+// Select lines of a 2-to-4 line decoder
+struct HostKeypadRows
+{
+    static constexpr uint8_t getNofPins()
+    {
+        return 2;
+    }
+
+    static void setAsOutput()
+    {}
+
+    static void write(const uint8_t value)
+    {
+        s_keypadRow = value;
+    }
+};
+
+// Three columns with pull-up resistors, pressed keys read as low
+struct HostKeypadColumns
+{
+    static constexpr uint8_t getNofPins()
+    {
+        return 3;
+    }
+
+    static uint8_t read()
+    {
+        return ~s_keypadKeys[s_keypadRow];
+    }
+};
+
+typedef MatrixScanner<LineDecoder<HostKeypadRows>, HostKeypadColumns> Keypad;
+
+static void scanKeypad(const uint8_t nofScans)
+{
+    for (uint8_t tick = 0; tick < nofScans * Keypad::getNofRows(); ++tick)
+    {
+        Keypad::tick();
+    }
+}
+
+static void testMatrixScanner()
+{
+    Keypad::init();
+    CHECK(Keypad::getNofKeys() == 12);
+
+    // Key 7 (row 2, column 1) is pressed after 4 identical samples
+    MatrixScannerEvent event;
+    s_keypadKeys[2] = 0x02;
+    scanKeypad(3);
+    CHECK(!Keypad::isPressed(7));
+    scanKeypad(1);
+    CHECK(Keypad::isPressed(7) && Keypad::getRow(2) == 0x02);
+    CHECK(Keypad::pop(event) && event.key == 7 && event.pressed);
+    CHECK(!Keypad::pop(event));
+
+    // Shorter bouncing is ignored
+    s_keypadKeys[2] = 0;
+    scanKeypad(3);
+    s_keypadKeys[2] = 0x02;
+    scanKeypad(4);
+    CHECK(Keypad::isPressed(7) && !Keypad::pop(event));
+
+    s_keypadKeys[2] = 0;
+    scanKeypad(4);
+    CHECK(!Keypad::isPressed(7));
+    CHECK(Keypad::pop(event) && event.key == 7 && !event.pressed);
+    CHECK(!Keypad::hasOverflowed());
+}
+
+// DSP
+
+static HostDSPIC33 s_dsp;
+typedef DSPIC33<SPIMaster, HostSSPin<s_dsp>> DSP;
+
+static void testParameterTable()
+{
+    typedef DSPIC33_ParameterTable<DSP, 40, 4> Parameters;
+
+    // Repeated updates are coalesced, dirty parameters are transferred in bursts of 4
+    Parameters::set(3, 10);
+    Parameters::set(3, 11);
+    Parameters::set(0, 9);
+    Parameters::set(17, 5);
+    Parameters::set(18, 6);
+    Parameters::set(19, 7);
+    Parameters::set(39, 1);
+    CHECK(Parameters::isDirty());
+
+    const uint32_t nofSelects = HostSPIBus::getNofSelects();
+    CHECK(Parameters::flush() == 6);
+    CHECK(HostSPIBus::getNofSelects() - nofSelects == 2);
+    CHECK(s_dsp.getNofParameterWrites() == 6);
+    CHECK(s_dsp.getParameter(0) == 9 && s_dsp.getParameter(3) == 11 && s_dsp.getParameter(17) == 5);
+    CHECK(s_dsp.getParameter(18) == 6 && s_dsp.getParameter(19) == 7 && s_dsp.getParameter(39) == 1);
+    CHECK(!Parameters::isDirty() && Parameters::flush() == 0);
+
+    // Unchanged values are not transferred. After a reset of the DSP, all parameters are transferred again
+    Parameters::set(17, 5);
+    CHECK(!Parameters::isDirty());
+    Parameters::invalidate();
+    CHECK(Parameters::flush() == 40);
+    CHECK(s_dsp.getNofParameterWrites() == 6 + 40);
+    CHECK(s_dsp.getNofErrors() == 0);
+}
+
+static void testDSPBlockTransfer()
+{
+    const uint16_t coefficients[] = {0x1234, 0xFFFF, 0x0001};
+    DSP::writeBlock(0x10, coefficients, 3, true);
+    CHECK(s_dsp.getWord(0x10) == 0x1234 && s_dsp.getWord(0x11) == 0xFFFF && s_dsp.getWord(0x12) == 0x0001);
+
+    s_dsp.getWord(0x80) = 0xABCD;
+    s_dsp.getWord(0x81) = 0x0102;
+    uint16_t meters[2] = {};
+    CHECK(DSP::readBlock(0x80, meters, 2, true));
+    CHECK(meters[0] == 0xABCD && meters[1] == 0x0102);
+
+    // Full-duplex: New values are written while the previous ones are read back
+    uint16_t values[2] = {0x1111, 0x2222};
+    CHECK(DSP::exchangeBlock(0x80, values, values, 2, true));
+    CHECK(values[0] == 0xABCD && values[1] == 0x0102);
+    CHECK(s_dsp.getWord(0x80) == 0x1111 && s_dsp.getWord(0x81) == 0x2222);
+    CHECK(s_dsp.getNofErrors() == 0);
+}
+
+// SPI bus scheduler
+
+static char s_busTrace[16];
+static uint8_t s_busTraceLength = 0;
+static uint8_t s_busData[4 * EEPROM::pageSize()];
+
+static void traceBus(const char device)
+{
+    if (s_busTraceLength + 1u < sizeof(s_busTrace))
+    {
+        s_busTrace[s_busTraceLength++] = device;
+        s_busTrace[s_busTraceLength] = '\0';
+    }
+}
+
+// One EEPROM page per step, SPI clock F_CPU / 2
+static bool writeEEPROMPage(SPIBusTransaction & transaction)
+{
+    CHECK((SPCR & 0x0F) == 0x00 && SPSR == _BV(SPI2X));
+    const uint16_t offset = transaction.progress * EEPROM::pageSize();
+    EEPROM::write(0x4000 + offset, static_cast<const uint8_t *>(transaction.context) + offset, EEPROM::pageSize());
+    traceBus('E');
+    return transaction.progress < 3;
+}
+
+// SPI clock F_CPU / 16, mode 3
+static bool readExpander(SPIBusTransaction & transaction)
+{
+    CHECK((SPCR & 0x0F) == 0x0D && SPSR == 0);
+    *static_cast<uint16_t *>(transaction.context) = Expander::read();
+    traceBus('X');
+    return false;
+}
+
+static bool idleStep(SPIBusTransaction &)
+{
+    return false;
+}
+
+static void testSPIBus()
+{
+    typedef SPIBus<AVRSPIConfig, 2, 2> Bus;
+
+    for (uint16_t idx = 0; idx < sizeof(s_busData); ++idx)
+    {
+        s_busData[idx] = idx ^ 0x5A;
+    }
+
+    // The expander read is submitted while the page writes are in progress and is executed at the next page boundary
+    uint16_t expanderValue = 0;
+    SPIBusTransaction pageWrite = {writeEEPROMPage, AVRSPIConfig::getSettings<EEPROM>(), s_busData, 0, false};
+    SPIBusTransaction expanderRead = {readExpander, AVRSPIConfig::getSettings(1000000UL, 3), &expanderValue, 0, false};
+    AVRSPIConfig::invalidate();
+    CHECK(Bus::submit(pageWrite, 1));
+    CHECK(Bus::run());
+    CHECK(Bus::submit(expanderRead, 0));
+    Bus::flush();
+    CHECK(strcmp(s_busTrace, "EXEEE") == 0);
+    CHECK(pageWrite.done && pageWrite.progress == 4);
+    CHECK(expanderRead.done && expanderRead.progress == 1);
+    CHECK((expanderValue & 0x0180) == 0x0080);
+    CHECK(Bus::isIdle() && !Bus::run());
+    EEPROM::waitWhileBusy();
+    CHECK(memcmp(s_eeprom.getMemory() + 0x4000, s_busData, sizeof(s_busData)) == 0);
+
+    // Queues of each priority level are of limited capacity
+    SPIBusTransaction steps[3] = {{idleStep, 0, nullptr, 0, false}, {idleStep, 0, nullptr, 0, false}, {idleStep, 0, nullptr, 0, false}};
+    CHECK(Bus::submit(steps[0], 1) && Bus::submit(steps[1], 1));
+    CHECK(!Bus::submit(steps[2], 1));
+    CHECK(Bus::submit(steps[2], 0));
+    Bus::flush();
+    CHECK(steps[0].done && steps[1].done && steps[2].done);
+
+    // Device pins switch the SPI clock themselves
+    typedef _25LC512<SPIMaster, SPIDevicePin<HostSSPin<s_eeprom>, 1000000UL, 3>> SlowEEPROM;
+    CHECK(SlowEEPROM::read(0x4001) == s_busData[1]);
+    CHECK((SPCR & 0x0F) == 0x0D && SPSR == 0);
+    CHECK(EEPROM::read(0x4002) == s_busData[2]);
+    CHECK((SPCR & 0x0F) == 0x0D);
+}
+
+// SPI instrumentation
+
+// CPU cycle counter
+struct HostCycleTimer
+{
+    static uint16_t now()
+    {
+        return HostClock::now() * (F_CPU / 1000000UL) / 1000;
+    }
+};
+
+typedef SPIStatistics<HostCycleTimer, 3> EEPROMStatistics;
+typedef _25LC512<SPIInstrumentedMaster<SPIMaster, EEPROMStatistics>, SPIInstrumentedPin<HostSSPin<s_eeprom>, EEPROMStatistics>> InstrumentedEEPROM;
+
+static void testSPIStatistics()
+{
+    uint8_t data[16];
+    for (uint8_t idx = 0; idx < sizeof(data); ++idx)
+    {
+        data[idx] = ~idx;
+    }
+
+    EEPROMStatistics::reset();
+    const uint32_t nofBytes = HostSPIBus::getNofBytes();
+    const uint32_t nofSelects = HostSPIBus::getNofSelects();
+    InstrumentedEEPROM::write(0x5000, data, sizeof(data));
+    InstrumentedEEPROM::waitWhileBusy();
+    uint8_t buffer[sizeof(data)];
+    InstrumentedEEPROM::read(0x5000, buffer, sizeof(buffer));
+    CHECK(memcmp(data, buffer, sizeof(data)) == 0);
+
+    CHECK(EEPROMStatistics::getNofTransactions() == HostSPIBus::getNofSelects() - nofSelects);
+    CHECK(EEPROMStatistics::getNofBytes() == HostSPIBus::getNofBytes() - nofBytes);
+
+    // At 8 MHz SPI clock, a byte takes 16 CPU cycles. Page write and read (instruction, address, 16 data bytes) fall into the last bucket
+    uint32_t nofTransactions = 0;
+    for (uint8_t bucket = 0; bucket < EEPROMStatistics::getNofBuckets(); ++bucket)
+    {
+        nofTransactions += EEPROMStatistics::getHistogram(bucket);
+    }
+    CHECK(nofTransactions == EEPROMStatistics::getNofTransactions());
+    CHECK(EEPROMStatistics::getHistogram(EEPROMStatistics::getNofBuckets() - 1) == 2);
+    CHECK(EEPROMStatistics::getMaxTicks() == 19 * 16);
+
+    // Polling the WIP bit caused the short transactions
+    char expected[40];
+    snprintf(expected, sizeof(expected), "3: %u t, %u B, ", static_cast<unsigned>(EEPROMStatistics::getNofTransactions()), static_cast<unsigned>(EEPROMStatistics::getNofBytes()));
+    EEPROMStatistics::dump<HostTextOutput>();
+    CHECK(strncmp(takeText(), expected, strlen(expected)) == 0);
+}
+
+int main()
+{
+    testRingBuffer();
+    testEEPROMWriteRead();
+    testLogRecovery();
+    testEEPROMWriteQueue();
+    testEEPROMCache();
+    testExpander();
+    testDebouncedSwitch();
+    testExpanderBus();
+    testExpander8();
+    testI2CExpanders();
+    testDisplay();
+    testDisplayConfiguration74HC595();
+    testDisplayAsync();
+    testDisplayStream();
+    testGlyphAnimation();
+    testShiftRegisterImage();
+    testScanner();
+    testMatrixScanner();
+    testParameterTable();
+    testDSPBlockTransfer();
+    testSPIBus();
+    testSPIStatistics();
+
+    CHECK(s_eeprom.getNofErrors() == 0);
+    CHECK(HostSPIBus::getNofErrors() == 0);
+    CHECK(HostTWIBus::getNofErrors() == 0);
+
+    printf("%s: %u failure(s)\n", (s_nofFailures == 0) ? "PASSED" : "FAILED", static_cast<unsigned>(s_nofFailures));
+    return (s_nofFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,251 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOST_TWI_H
+#define HOST_TWI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "host_clock.h"
+
+/**
+@brief Interface of emulated I2C devices
+*/
+class HostTWIDevice
+{
+    public:
+
+    /**
+    @brief Called on START or repeated START
+    @param address Slave address byte, i.e. 7 bit slave address and R/W bit
+    @result true if the device acknowledges the address
+    */
+    virtual bool start(const uint8_t address) = 0;
+
+    /**
+    @brief Receive one byte from the master
+    @param data Byte sent by the master
+    @result true if the device acknowledges the byte
+    */
+    virtual bool write(const uint8_t data) = 0;
+
+    /**
+    @brief Send one byte to the master
+    @param ack true if the master acknowledges the byte, false for the last byte of a read
+    @result Byte sent by the device
+    */
+    virtual uint8_t read(const bool ack) = 0;
+
+    /// @brief Called on STOP
+    virtual void stop() {}
+
+    protected:
+
+    ~HostTWIDevice() = default;
+};
+
+/**
+@brief Emulated I2C bus recording the traffic of all devices
+Bytes are routed to the device which has acknowledged the last slave address. Bytes without addressed device, unacknowledged addresses and reads in write direction (or vice versa) are counted as errors
+*/
+class HostTWIBus
+{
+    public:
+
+    /**
+    @brief Connect a device to the bus
+    @param device Emulated device. Devices are connected until the next detachAll()
+    */
+    static void attach(HostTWIDevice & device)
+    {
+        if (s_nofDevices < MAX_NOF_DEVICES)
+        {
+            s_devices[s_nofDevices++] = &device;
+        }
+        else
+        {
+            ++s_nofErrors;
+        }
+    }
+
+    /// @brief Disconnect all devices
+    static void detachAll()
+    {
+        s_nofDevices = 0;
+        s_device = nullptr;
+    }
+
+    static void start(const uint8_t address)
+    {
+        ++s_nofStarts;
+        ++s_nofBytes;
+        s_device = nullptr;
+        s_read = address & 0x01;
+
+        for (uint8_t idx = 0; idx < s_nofDevices; ++idx)
+        {
+            if (s_devices[idx]->start(address))
+            {
+                s_device = s_devices[idx];
+                return;
+            }
+        }
+
+        // Address not acknowledged
+        ++s_nofErrors;
+    }
+
+    static void write(const uint8_t data)
+    {
+        ++s_nofBytes;
+        if (s_device == nullptr || s_read || !s_device->write(data))
+        {
+            ++s_nofErrors;
+        }
+    }
+
+    static uint8_t read(const bool ack)
+    {
+        ++s_nofBytes;
+        if (s_device == nullptr || !s_read)
+        {
+            ++s_nofErrors;
+            return 0xFF;
+        }
+        return s_device->read(ack);
+    }
+
+    static void stop()
+    {
+        if (s_device != nullptr)
+        {
+            s_device->stop();
+            s_device = nullptr;
+        }
+    }
+
+    /// @brief Reset all counters
+    static void reset()
+    {
+        s_nofBytes = 0;
+        s_nofStarts = 0;
+        s_nofErrors = 0;
+    }
+
+    /**
+    @brief Get the number of bytes on the wire since the last reset
+    @result Number of bytes including slave address bytes
+    */
+    static uint32_t getNofBytes()
+    {
+        return s_nofBytes;
+    }
+
+    /**
+    @brief Get the number of START conditions since the last reset
+    @result Number of START and repeated START conditions
+    */
+    static uint32_t getNofStarts()
+    {
+        return s_nofStarts;
+    }
+
+    /**
+    @brief Get the number of protocol errors since the last reset
+    @result Number of bytes not acknowledged or without addressed device
+    */
+    static uint32_t getNofErrors()
+    {
+        return s_nofErrors;
+    }
+
+    private:
+
+    static constexpr uint8_t MAX_NOF_DEVICES = 8;
+
+    static HostTWIDevice * s_devices[MAX_NOF_DEVICES];
+    static uint8_t s_nofDevices;
+    static HostTWIDevice * s_device;
+    static bool s_read;
+    static uint32_t s_nofBytes;
+    static uint32_t s_nofStarts;
+    static uint32_t s_nofErrors;
+};
+
+// Static initialization. HostTWIBus is not a template, so the definitions are inline to allow inclusion by multiple translation units
+inline HostTWIDevice * HostTWIBus::s_devices[HostTWIBus::MAX_NOF_DEVICES] = {};
+inline uint8_t HostTWIBus::s_nofDevices = 0;
+inline HostTWIDevice * HostTWIBus::s_device = nullptr;
+inline bool HostTWIBus::s_read = false;
+inline uint32_t HostTWIBus::s_nofBytes = 0;
+inline uint32_t HostTWIBus::s_nofStarts = 0;
+inline uint32_t HostTWIBus::s_nofErrors = 0;
+
+/**
+@brief Mock TWI master driver class
+Implements the TWI master interface used by the drivers. Each byte advances HostClock by 9 SCL cycles (8 data bits and ACK), START and STOP by one SCL cycle each
+@tparam t_clock SCL clock in Hz
+*/
+template <uint32_t t_clock = 400000UL>
+class HostTWIMaster
+{
+    public:
+
+    static void init() {}
+
+    /**
+    @brief Transfer START (or repeated START) and slave address byte
+    @param address Slave address byte, i.e. 7 bit slave address and R/W bit
+    */
+    static void start(const uint8_t address)
+    {
+        advance(1 + 9);
+        HostTWIBus::start(address);
+    }
+
+    static void put(const uint8_t data)
+    {
+        advance(9);
+        HostTWIBus::write(data);
+    }
+
+    /**
+    @brief Receive one byte
+    @param ack true to acknowledge the byte, false for the last byte of a read
+    @result Received byte
+    */
+    static uint8_t get(const bool ack)
+    {
+        advance(9);
+        return HostTWIBus::read(ack);
+    }
+
+    static void stop()
+    {
+        advance(1);
+        HostTWIBus::stop();
+    }
+
+    private:
+
+    static void advance(const uint8_t nofCycles)
+    {
+        HostClock::advance(nofCycles * (1000000000ULL / t_clock));
+    }
+};
+
+#endif
@@ -0,0 +1,35 @@
+/*
+Copyright (C) 2022  Andreas Lagler
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOST_UTIL_DELAY_H
+#define HOST_UTIL_DELAY_H
+
+// Host stub of <util/delay.h>: Delays advance the modeled time instead of busy-waiting
+
+#include "host_clock.h"
+
+inline void _delay_us(const double us)
+{
+    HostClock::advance(static_cast<uint64_t>(us * 1000.0));
+}
+
+inline void _delay_ms(const double ms)
+{
+    HostClock::advance(static_cast<uint64_t>(ms * 1000000.0));
+}
+
+#endif